@@ -0,0 +1,134 @@
+/**
+ * @file distance_filter_bench.cpp
+ * @brief Benchmark: plane-sweep distance test, per-candidate loop vs batched kernels
+ *
+ * Sorts a bundled dataset by X like the plane sweep does and runs every sweep row
+ * through the neighbor test: the original one-candidate loop (std::pow / std::sqrt
+ * per candidate) and each available distfilter kernel. Reports ns per candidate and
+ * checks that all variants accept the same pairs.
+ *
+ * Usage: bench_distance_filter <dataset.csv> <distance>
+ */
+
+#include "data_loader.h"
+#include "distance_filter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+	double secondsSince(std::chrono::high_resolution_clock::time_point start) {
+		return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// Repeat fn (one full sweep) until at least minSeconds have passed; returns seconds per sweep
+	template <typename Fn>
+	double timeSweeps(size_t& accepted, Fn fn) {
+		const double minSeconds = 0.3;
+		size_t rounds = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		double elapsed = 0.0;
+		do {
+			accepted = fn();
+			++rounds;
+			elapsed = secondsSince(start);
+		} while (elapsed < minSeconds);
+		return elapsed / rounds;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cerr << "Usage: bench_distance_filter <dataset.csv> <distance>\n";
+		return 1;
+	}
+	double d = std::atof(argv[2]);
+
+	// Sweep order: instances sorted by X, columns gathered contiguously
+	auto dataset = DataLoader::load(argv[1]);
+	const InstanceTable& instances = dataset.instances;
+	std::vector<size_t> order(instances.size());
+	for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return instances.x[a] < instances.x[b]; });
+
+	size_t n = order.size();
+	std::vector<double> xs(n), ys(n);
+	std::vector<FeatureType> features(n);
+	for (size_t i = 0; i < n; ++i) {
+		xs[i] = instances.x[order[i]];
+		ys[i] = instances.y[order[i]];
+		features[i] = instances.feature[order[i]];
+	}
+
+	std::vector<size_t> windowEnd(n);
+	size_t candidates = 0;
+	for (size_t i = 0; i < n; ++i) {
+		windowEnd[i] = std::partition_point(xs.begin() + i + 1, xs.end(),
+			[&](double x) { return x - xs[i] <= d; }) - xs.begin();
+		candidates += windowEnd[i] - i - 1;
+	}
+	if (candidates == 0) {
+		std::cerr << "No sweep candidates at distance " << d << "\n";
+		return 1;
+	}
+
+	std::cout << "instances=" << n << " candidates=" << candidates
+		<< " avg window=" << std::fixed << std::setprecision(1) << double(candidates) / n << "\n";
+	std::cout << "detected kernel: " << distfilter::kernelName(distfilter::detectKernel()) << "\n\n";
+	std::cout << std::setw(20) << "variant"
+		<< std::setw(16) << "ns/candidate"
+		<< std::setw(14) << "sweep (ms)"
+		<< std::setw(12) << "pairs" << "\n";
+
+	// The loop findNeighborPair ran before the batched filter
+	size_t refPairs = 0;
+	double refTime = timeSweeps(refPairs, [&]() {
+		size_t pairs = 0;
+		for (size_t i = 0; i < n; ++i) {
+			for (size_t j = i + 1; j < n; ++j) {
+				if (xs[j] - xs[i] > d) break;
+				if (std::abs(ys[j] - ys[i]) <= d) {
+					double dist = std::sqrt(std::pow(xs[i] - xs[j], 2) + std::pow(ys[i] - ys[j], 2));
+					if (dist <= d && features[i] != features[j]) ++pairs;
+				}
+			}
+		}
+		return pairs;
+		});
+	std::cout << std::setw(20) << "per-candidate loop" << std::setprecision(2)
+		<< std::setw(16) << refTime * 1e9 / candidates
+		<< std::setw(14) << refTime * 1e3
+		<< std::setw(12) << refPairs << "\n";
+
+	distfilter::Points points{ xs.data(), ys.data(), features.data() };
+	std::vector<int32_t> hits(n);
+	for (distfilter::Kernel kernel : { distfilter::Kernel::Scalar, distfilter::Kernel::AVX2 }) {
+		if (!distfilter::setKernel(kernel)) {
+			std::cout << std::setw(20) << distfilter::kernelName(kernel) << "   (not supported by this CPU)\n";
+			continue;
+		}
+		size_t pairs = 0;
+		double t = timeSweeps(pairs, [&]() {
+			size_t accepted = 0;
+			for (size_t i = 0; i < n; ++i) {
+				accepted += distfilter::filter(points, i, i + 1, windowEnd[i], d, hits.data());
+			}
+			return accepted;
+			});
+		if (pairs != refPairs) {
+			std::cerr << "Mismatch in kernel " << distfilter::kernelName(kernel) << ": " << pairs << " vs " << refPairs << "\n";
+			return 1;
+		}
+		std::cout << std::setw(20) << distfilter::kernelName(kernel)
+			<< std::setw(16) << t * 1e9 / candidates
+			<< std::setw(14) << t * 1e3
+			<< std::setw(12) << pairs << "\n";
+	}
+	distfilter::setKernel(distfilter::detectKernel());
+	return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file neighbor_scaling_bench.cpp
+ * @brief Benchmark: wall-clock scaling of the neighbor-graph build with the thread count
+ *
+ * Builds the neighbor graph of one dataset with the plane sweep and the grid engine at
+ * 1, 2, 4, ... threads (up to maxThreads, default: twice the hardware threads) and
+ * reports the best of a few runs, the speedup over 1 thread and whether the graph is
+ * identical to the 1-thread graph.
+ *
+ * Usage: bench_neighbor_scaling <dataset.csv> <distance> [maxThreads]
+ */
+
+#include "data_loader.h"
+#include "neighbor_graph.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	// Best wall time of a few builds; graph receives the last one
+	double timeBuild(const InstanceTable& instances, double d, NeighborSearchMethod method,
+		unsigned threads, CSRGraph& graph) {
+		const int rounds = 3;
+		double best = 0.0;
+		for (int r = 0; r < rounds; ++r) {
+			NeighborGraph builder(threads);
+			auto start = std::chrono::high_resolution_clock::now();
+			graph = builder.buildNeighborGraph(instances, d, method);
+			double t = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+			best = (r == 0) ? t : std::min(best, t);
+		}
+		return best;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cerr << "Usage: bench_neighbor_scaling <dataset.csv> <distance> [maxThreads]\n";
+		return 1;
+	}
+	double d = std::atof(argv[2]);
+	unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+	unsigned maxThreads = (argc > 3) ? static_cast<unsigned>(std::atoi(argv[3])) : 2 * hardware;
+
+	auto dataset = DataLoader::load(argv[1]);
+	const InstanceTable& instances = dataset.instances;
+	std::cout << "instances=" << instances.size() << " d=" << d << " hardware threads=" << hardware << "\n\n";
+	std::cout << std::setw(8) << "engine" << std::setw(10) << "threads"
+		<< std::setw(14) << "time (ms)" << std::setw(10) << "speedup"
+		<< std::setw(14) << "edges" << std::setw(12) << "identical" << "\n";
+
+	for (NeighborSearchMethod method : { NeighborSearchMethod::PlaneSweep, NeighborSearchMethod::Grid }) {
+		const char* name = (method == NeighborSearchMethod::Grid) ? "grid" : "sweep";
+		CSRGraph reference;
+		double base = timeBuild(instances, d, method, 1, reference);
+		for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+			CSRGraph graph;
+			double t = (threads == 1) ? base : timeBuild(instances, d, method, threads, graph);
+			bool identical = threads == 1
+				|| (graph.offsets == reference.offsets && graph.neighbors == reference.neighbors);
+			std::cout << std::setw(8) << name << std::setw(10) << threads
+				<< std::setw(14) << std::fixed << std::setprecision(1) << t * 1e3
+				<< std::setw(10) << std::setprecision(2) << base / t
+				<< std::setw(14) << reference.neighbors.size() / 2
+				<< std::setw(12) << (identical ? "yes" : "NO") << "\n";
+		}
+	}
+	return 0;
+}
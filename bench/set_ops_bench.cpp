@@ -0,0 +1,138 @@
+/**
+ * @file set_ops_bench.cpp
+ * @brief Benchmark: sorted-set intersection kernels on real neighbor lists
+ *
+ * Builds the neighbor graph of a bundled dataset and intersects the neighbor lists of
+ * the endpoints of sampled edges, the same operation pivot selection performs. Each
+ * available kernel (scalar, SSE4.2, AVX2) is timed against std::set_intersection.
+ *
+ * Usage: bench_set_ops <dataset.csv> <distance> [numPairs]
+ */
+
+#include "data_loader.h"
+#include "neighbor_graph.h"
+#include "set_ops.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace {
+
+	struct ListPair {
+		const int32_t* a;
+		size_t na;
+		const int32_t* b;
+		size_t nb;
+	};
+
+	double secondsSince(std::chrono::high_resolution_clock::time_point start) {
+		return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// Repeat the whole pair list until at least minSeconds have passed; returns ns per pair
+	template <typename Fn>
+	double timePairs(const std::vector<ListPair>& pairs, size_t& checksum, Fn fn) {
+		const double minSeconds = 0.2;
+		size_t rounds = 0;
+		checksum = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		double elapsed = 0.0;
+		do {
+			for (const auto& p : pairs) checksum += fn(p);
+			++rounds;
+			elapsed = secondsSince(start);
+		} while (elapsed < minSeconds);
+		return elapsed * 1e9 / (double(rounds) * pairs.size());
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cerr << "Usage: bench_set_ops <dataset.csv> <distance> [numPairs]\n";
+		return 1;
+	}
+	double distance = std::atof(argv[2]);
+	size_t numPairs = (argc > 3) ? static_cast<size_t>(std::atol(argv[3])) : 100000;
+
+	auto dataset = DataLoader::load_csv(argv[1]);
+	NeighborGraph neighborGraph;
+	CSRGraph graph = neighborGraph.buildNeighborGraph(dataset.instances, distance);
+	if (graph.neighbors.empty()) {
+		std::cerr << "Neighbor graph has no edges at distance " << distance << "\n";
+		return 1;
+	}
+
+	// Sample edges (u, v) uniformly: pick a CSR slot, find its row
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<size_t> slot(0, graph.neighbors.size() - 1);
+	std::vector<ListPair> pairs;
+	pairs.reserve(numPairs);
+	double avgA = 0.0, avgB = 0.0;
+	for (size_t i = 0; i < numPairs; ++i) {
+		size_t s = slot(rng);
+		int32_t u = static_cast<int32_t>(std::upper_bound(graph.offsets.begin(), graph.offsets.end(), s) - graph.offsets.begin() - 1);
+		int32_t v = graph.neighbors[s];
+		pairs.push_back({ graph.rowBegin(u), graph.degree(u), graph.rowBegin(v), graph.degree(v) });
+		avgA += graph.degree(u);
+		avgB += graph.degree(v);
+	}
+
+	std::cout << "vertices=" << graph.numVertices() << " edges=" << graph.neighbors.size() / 2
+		<< " pairs=" << pairs.size() << " avg list sizes=" << std::fixed << std::setprecision(1)
+		<< avgA / pairs.size() << " / " << avgB / pairs.size() << "\n";
+	std::cout << "detected kernel: " << setops::kernelName(setops::detectKernel()) << "\n\n";
+	std::cout << std::setw(20) << "kernel"
+		<< std::setw(16) << "count (ns)"
+		<< std::setw(16) << "intersect (ns)"
+		<< std::setw(16) << "difference (ns)" << "\n";
+
+	std::vector<int32_t> out(graph.numVertices());
+
+	size_t refIntersect = 0, refDifference = 0;
+	double stdIntersect = timePairs(pairs, refIntersect, [&](const ListPair& p) {
+		return static_cast<size_t>(std::set_intersection(p.a, p.a + p.na, p.b, p.b + p.nb, out.data()) - out.data());
+		});
+	double stdDifference = timePairs(pairs, refDifference, [&](const ListPair& p) {
+		return static_cast<size_t>(std::set_difference(p.a, p.a + p.na, p.b, p.b + p.nb, out.data()) - out.data());
+		});
+	std::cout << std::setw(20) << "std algorithms" << std::setprecision(1)
+		<< std::setw(16) << "-" << std::setw(16) << stdIntersect << std::setw(16) << stdDifference << "\n";
+
+	for (setops::Kernel kernel : { setops::Kernel::Scalar, setops::Kernel::SSE42, setops::Kernel::AVX2 }) {
+		if (!setops::setKernel(kernel)) {
+			std::cout << std::setw(20) << setops::kernelName(kernel) << "   (not supported by this CPU)\n";
+			continue;
+		}
+		size_t c1 = 0, c2 = 0, c3 = 0;
+		double tCount = timePairs(pairs, c1, [&](const ListPair& p) {
+			return setops::intersectCount(p.a, p.na, p.b, p.nb);
+			});
+		double tIntersect = timePairs(pairs, c2, [&](const ListPair& p) {
+			return setops::intersect(p.a, p.na, p.b, p.nb, out.data());
+			});
+		double tDifference = timePairs(pairs, c3, [&](const ListPair& p) {
+			return setops::difference(p.a, p.na, p.b, p.nb, out.data());
+			});
+
+		// Checksums depend on the number of rounds, so compare per-round results instead
+		size_t perRoundRef = 0, perRound = 0;
+		for (const auto& p : pairs) {
+			perRoundRef += static_cast<size_t>(std::set_intersection(p.a, p.a + p.na, p.b, p.b + p.nb, out.data()) - out.data());
+			perRound += setops::intersect(p.a, p.na, p.b, p.nb, out.data());
+		}
+		if (perRound != perRoundRef) {
+			std::cerr << "Mismatch in kernel " << setops::kernelName(kernel) << "\n";
+			return 1;
+		}
+
+		std::cout << std::setw(20) << setops::kernelName(kernel)
+			<< std::setw(16) << tCount << std::setw(16) << tIntersect << std::setw(16) << tDifference << "\n";
+	}
+	setops::setKernel(setops::detectKernel());
+	return 0;
+}
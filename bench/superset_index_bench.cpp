@@ -0,0 +1,115 @@
+/**
+ * @file superset_index_bench.cpp
+ * @brief Benchmark: superset queries, linear key scan vs SupersetIndex
+ *
+ * Generates synthetic maximal-clique keys (skewed feature frequencies, 2-8 features
+ * per key) and measures the average time to find all supersets of a candidate as
+ * the number of distinct keys grows.
+ *
+ * Usage: bench_superset_index [numFeatures] [numQueries]
+ */
+
+#include "superset_index.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+	// Random key: 2-8 distinct features, low ids much more frequent than high ids
+	Colocation randomKey(std::mt19937& rng, int numFeatures) {
+		std::uniform_int_distribution<int> sizeDist(2, 8);
+		std::uniform_real_distribution<double> u(0.0, 1.0);
+		Colocation key;
+		int target = std::min(sizeDist(rng), numFeatures);
+		while ((int)key.size() < target) {
+			double r = u(rng);
+			key.insert(static_cast<FeatureType>(r * r * numFeatures));
+		}
+		return key;
+	}
+
+	// Candidate: 2-4 features taken from an existing key, like minePCPs subsets
+	Colocation randomCandidate(std::mt19937& rng, const std::vector<Colocation>& keys) {
+		const Colocation& key = keys[rng() % keys.size()];
+		std::vector<FeatureType> features(key.begin(), key.end());
+		std::shuffle(features.begin(), features.end(), rng);
+		size_t target = std::min<size_t>(features.size(), 2 + rng() % 3);
+		Colocation c;
+		for (size_t i = 0; i < target; ++i) c.insert(features[i]);
+		return c;
+	}
+
+	double secondsSince(std::chrono::high_resolution_clock::time_point start) {
+		return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char* argv[]) {
+	int numFeatures = (argc > 1) ? std::atoi(argv[1]) : 30;
+	int numQueries = (argc > 2) ? std::atoi(argv[2]) : 2000;
+	if (numFeatures < 2 || numFeatures > (int)Colocation::kCapacity) {
+		std::cerr << "numFeatures must be in [2, " << Colocation::kCapacity << "]\n";
+		return 1;
+	}
+
+	std::cout << "features=" << numFeatures << " queries=" << numQueries << "\n";
+	std::cout << std::setw(10) << "keys"
+		<< std::setw(16) << "scan (us/q)"
+		<< std::setw(16) << "index (us/q)"
+		<< std::setw(10) << "speedup"
+		<< std::setw(14) << "avg matches" << "\n";
+
+	std::mt19937 rng(42);
+	for (size_t target : { 1000u, 10000u, 100000u, 1000000u }) {
+		// Distinct keys, as produced by the clique hashmap
+		std::unordered_set<Colocation> unique;
+		size_t attempts = 0;
+		while (unique.size() < target && attempts < target * 50) {
+			unique.insert(randomKey(rng, numFeatures));
+			++attempts;
+		}
+		std::vector<Colocation> keys(unique.begin(), unique.end());
+
+		std::vector<Colocation> queries;
+		queries.reserve(numQueries);
+		for (int q = 0; q < numQueries; ++q) queries.push_back(randomCandidate(rng, keys));
+
+		SupersetIndex index;
+		index.build(keys);
+
+		// Linear scan, as queryInstances did before
+		size_t scanMatches = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (const auto& c : queries) {
+			for (const auto& key : keys) {
+				if (c.isSubsetOf(key)) ++scanMatches;
+			}
+		}
+		double scanTime = secondsSince(start);
+
+		size_t indexMatches = 0;
+		start = std::chrono::high_resolution_clock::now();
+		for (const auto& c : queries) {
+			indexMatches += index.query(c).size();
+		}
+		double indexTime = secondsSince(start);
+
+		if (scanMatches != indexMatches) {
+			std::cerr << "Mismatch at " << keys.size() << " keys: " << scanMatches << " vs " << indexMatches << "\n";
+			return 1;
+		}
+
+		std::cout << std::setw(10) << keys.size()
+			<< std::setw(16) << std::fixed << std::setprecision(2) << scanTime * 1e6 / numQueries
+			<< std::setw(16) << indexTime * 1e6 / numQueries
+			<< std::setw(9) << std::setprecision(1) << (indexTime > 0 ? scanTime / indexTime : 0.0) << "x"
+			<< std::setw(14) << std::setprecision(1) << (double)indexMatches / numQueries << "\n";
+	}
+	return 0;
+}
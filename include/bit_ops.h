@@ -0,0 +1,35 @@
+/**
+ * @file bit_ops.h
+ * @brief Portable popcount / bit-scan helpers
+ */
+
+#pragma once
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace bits {
+
+	// Number of set bits in a word
+	inline int popcount(uint64_t w) {
+#ifdef _MSC_VER
+		return static_cast<int>(__popcnt64(w));
+#else
+		return __builtin_popcountll(w);
+#endif
+	}
+
+	// Index of the lowest set bit (w must be non-zero)
+	inline int lowestBit(uint64_t w) {
+#ifdef _MSC_VER
+		unsigned long idx;
+		_BitScanForward64(&idx, w);
+		return static_cast<int>(idx);
+#else
+		return __builtin_ctzll(w);
+#endif
+	}
+
+} // namespace bits
@@ -0,0 +1,126 @@
+/**
+ * @file clique_sink.h
+ * @brief Receivers for the cliques produced by maximal clique enumeration
+ */
+
+#pragma once
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Consumer of enumerated cliques
+ *
+ * MaximalCliqueHashmap::enumerate calls onClique once per reported clique with the
+ * instance indices (into the graph's instance vector) of its vertices. With several
+ * threads, every worker gets its own sink from fork() and the enumeration folds them
+ * back into the root sink with join(), in worker order, before calling finish().
+ *
+ * In feature-aware mode one call may carry several instances of the same feature:
+ * all of them participate in the colocation given by the call's feature set.
+ */
+class CliqueSink {
+public:
+	virtual ~CliqueSink() = default;
+
+	// One clique (count >= 2 vertices); vertices is only valid during the call
+	virtual void onClique(const int32_t* vertices, size_t count) = 0;
+
+	// Independent sink for one worker thread
+	virtual std::unique_ptr<CliqueSink> fork() = 0;
+
+	// Fold the results of a forked sink into this one
+	virtual void join(CliqueSink& worker) = 0;
+
+	// Called once on the root sink after enumeration
+	virtual void finish() {}
+};
+
+/**
+ * @brief Groups participating instances by colocation key (the classic CliqueHashMap)
+ */
+class HashmapSink : public CliqueSink {
+public:
+	// Aggregate into target, which must outlive the sink
+	HashmapSink(const InstanceTable& instances, CliqueHashMap& target)
+		: instances(instances), target(&target) {}
+
+	void onClique(const int32_t* vertices, size_t count) override;
+	std::unique_ptr<CliqueSink> fork() override;
+	void join(CliqueSink& worker) override;
+
+	// Compress every participating-instance bitmap
+	void finish() override;
+
+private:
+	const InstanceTable& instances;
+	CliqueHashMap* target;
+	CliqueHashMap owned;  ///< Storage of forked sinks
+};
+
+/**
+ * @brief Counts cliques without storing them (enumeration-only benchmarks)
+ */
+class CountingSink : public CliqueSink {
+public:
+	size_t cliques = 0;    ///< onClique calls
+	size_t vertices = 0;   ///< Sum of clique sizes
+	size_t maxSize = 0;    ///< Largest clique
+
+	void onClique(const int32_t* vertices, size_t count) override;
+	std::unique_ptr<CliqueSink> fork() override;
+	void join(CliqueSink& worker) override;
+};
+
+/**
+ * @brief Appends cliques to a binary file so enumeration output takes bounded memory
+ *
+ * This does not bound the memory of a whole run. Mining needs the aggregated
+ * CliqueHashMap, and replaying the file builds it in full, so peak memory is that of
+ * the hashmap path whenever the hashmap dominates. main only releases the neighbor
+ * graph and the instance coordinates before the replay.
+ *
+ * File layout: "CLQ1", then one record per clique: uint32 count, count x int32
+ * instance indices. Forked sinks buffer records and append them to the shared file
+ * under a lock. replaySpill() feeds a spill file into another sink.
+ */
+class SpillSink : public CliqueSink {
+public:
+	explicit SpillSink(const std::string& path);
+	~SpillSink() override;
+
+	bool isOpen() const { return shared && shared->out.is_open(); }
+	size_t bytesWritten() const { return shared ? shared->bytes : 0; }
+
+	void onClique(const int32_t* vertices, size_t count) override;
+	std::unique_ptr<CliqueSink> fork() override;
+	void join(CliqueSink& worker) override;
+	void finish() override;
+
+private:
+	/** @brief Output file shared by the root sink and its forks */
+	struct SharedFile {
+		std::ofstream out;
+		std::mutex mutex;
+		size_t bytes = 0;
+	};
+
+	static constexpr size_t kFlushWords = size_t(1) << 16;  ///< Buffered int32 words before a flush
+
+	std::shared_ptr<SharedFile> shared;
+	std::vector<int32_t> buffer;
+
+	explicit SpillSink(std::shared_ptr<SharedFile> shared) : shared(std::move(shared)) {}
+	void flush();
+};
+
+/**
+ * @brief Replay a file written by SpillSink into another sink
+ * @return bool False if the file is missing or malformed
+ */
+bool replaySpill(const std::string& path, CliqueSink& sink);
@@ -0,0 +1,82 @@
+/**
+ * @file columnar_dataset.h
+ * @brief Binary columnar dataset format, read through a memory mapping
+ *
+ * Layout (little-endian, every section 8-byte aligned):
+ * - Header: magic "CLDB", version, row count, feature count, flags, section offsets
+ * - Feature dictionary: per feature id, uint32 name length + name bytes (ids in name order)
+ * - Columns: feature id (uint16), instance number (int32), x (double), y (double),
+ *   checkin (double, present only if the source CSV had a Checkin column)
+ *
+ * Row i is instance id i, exactly as DataLoader::load_csv numbers the CSV rows.
+ */
+
+#pragma once
+#include "mapped_file.h"
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Zero-copy view of a binary columnar dataset
+ *
+ * The column pointers point straight into the mapping and stay valid as long as
+ * the object lives.
+ */
+class ColumnarDataset {
+public:
+	/** @brief Fixed-size file header */
+	struct Header {
+		char magic[4];            ///< "CLDB"
+		uint32_t version;         ///< kVersion
+		uint64_t numRows;         ///< Instances in the file
+		uint32_t numFeatures;     ///< Entries in the feature dictionary
+		uint32_t flags;           ///< kHasCheckin
+		uint64_t dictionaryOffset;
+		uint64_t featureOffset;
+		uint64_t instanceOffset;
+		uint64_t xOffset;
+		uint64_t yOffset;
+		uint64_t checkinOffset;   ///< 0 when there is no checkin column
+	};
+
+	static constexpr uint32_t kVersion = 1;
+	static constexpr uint32_t kHasCheckin = 1;
+
+	// Map and validate path; throws std::runtime_error on a malformed file
+	explicit ColumnarDataset(const std::string& path);
+
+	size_t size() const { return static_cast<size_t>(header.numRows); }
+	const std::vector<std::string>& featureNames() const { return names; }
+
+	const FeatureType* featureIds() const { return featureColumn; }
+	const int32_t* instanceNumbers() const { return instanceColumn; }
+	const double* xs() const { return xColumn; }
+	const double* ys() const { return yColumn; }
+	const double* checkins() const { return checkinColumn; }  ///< nullptr without a checkin column
+
+	// True if path starts with the columnar magic
+	static bool isColumnarFile(const std::string& path);
+
+	// Write a dataset; featureIds must already follow the (sorted) name order.
+	// checkin may be empty. Throws std::runtime_error if the file cannot be written.
+	static void write(const std::string& path,
+		const std::vector<std::string>& featureNames,
+		const std::vector<FeatureType>& featureIds,
+		const std::vector<int32_t>& instanceNumbers,
+		const std::vector<double>& x,
+		const std::vector<double>& y,
+		const std::vector<double>& checkin);
+
+private:
+	MappedFile file;
+	Header header{};
+	std::vector<std::string> names;
+	const FeatureType* featureColumn = nullptr;
+	const int32_t* instanceColumn = nullptr;
+	const double* xColumn = nullptr;
+	const double* yColumn = nullptr;
+	const double* checkinColumn = nullptr;
+};
@@ -20,14 +20,23 @@
 struct AppConfig {
     // I/O Settings
     std::string datasetPath;    ///< Path to input CSV dataset file
-    std::string outputPath;     ///< Path to output results file
+    std::string outputPath;     ///< Path to the colocation rules file (empty = no rule generation)
 
     // Algorithm Parameters
     double neighborDistance;    ///< Distance threshold for spatial neighbors
     double minPrev;            ///< Minimum prevalence threshold (0.0 to 1.0)
     double minCondProb;        ///< Minimum conditional probability for rules (0.0 to 1.0)
+    int topK;                  ///< Report only the K patterns with the highest weighted PI (0 = all prevalent patterns)
+    std::string neighborMethod; ///< Neighbor search engine: "grid" or "sweep"
+    std::string reorder;        ///< Instance renumbering before the graph: "none", "morton" or "hilbert"
+    bool featureAwareEnumeration; ///< Report each feature-multipartite BK branch once instead of per clique
+    std::string cliqueSink;     ///< Clique consumer: "hashmap", "spill" or "count"
+    std::string spillPath;      ///< Spill file used when cliqueSink is "spill"
+    double tileSize;            ///< Side of the out-of-core tiles (0 = load the whole dataset)
+    std::string tileDir;        ///< Scratch directory for tile buckets and results
 
     // System Settings
+    int numThreads;            ///< Worker threads for parallel stages (0 = all hardware threads)
     bool debugMode;            ///< Enable debug output messages
 
     /**
@@ -42,6 +51,15 @@ struct AppConfig {
         neighborDistance(5.0),
         minPrev(0.6),
         minCondProb(0.5),
+        topK(0),
+        neighborMethod("grid"),
+        reorder("none"),
+        featureAwareEnumeration(false),
+        cliqueSink("hashmap"),
+        spillPath("cliques.spill"),
+        tileSize(0.0),
+        tileDir("tiles"),
+        numThreads(1),
         debugMode(false) {
     }
 };
@@ -1,33 +1,118 @@
 /**
  * @file data_loader.h
- * @brief CSV data loading functionality for spatial instances
+ * @brief Data loading functionality for spatial instances (CSV and binary columnar)
  */
 
 #pragma once
 #include "types.h"
 #include "csv.hpp"
+#include <functional>
 #include <string>
 #include <vector>
 
  /**
-  * @brief DataLoader class for loading spatial instances from CSV files
+  * @brief DataLoader class for loading spatial instances from CSV or columnar files
   *
-  * Provides static methods to parse CSV datasets containing spatial feature instances.
+  * Provides static methods to parse CSV datasets containing spatial feature instances,
+  * to convert them to the binary columnar format (columnar_dataset.h) and to load that
+  * format back through a memory mapping.
   */
 class DataLoader {
 public:
+    /** @brief Row consumer for scan_csv: (feature name, instance number, x, y, checkin) */
+    using RowCallback = std::function<void(const std::string&, int, double, double, double)>;
+
+    /**
+     * @brief Stream every row of a CSV dataset to a callback without storing it
+     *
+     * Same columns as load_csv, read through csv.hpp, which buffers about 10 MB of text
+     * and its parsed rows at a time.
+     *
+     * @param filepath Path to the CSV file
+     * @param onRow Called once per row, in file order (checkin is 0 without a Checkin column)
+     * @return bool True if the file has a Checkin column
+     */
+    static bool scan_csv(const std::string& filepath, const RowCallback& onRow);
+
+    /**
+     * @brief Stream every row of a CSV or columnar dataset (detected from the file contents)
+     *
+     * Used by the tiled mode, which cannot hold the whole dataset in memory. Plain CSV
+     * files are read one bounded block at a time (twice: the first pass only checks that
+     * every row parses); anything else goes through scan_csv.
+     *
+     * @param filepath Path to the dataset
+     * @param onRow Called once per row, in file order
+     */
+    static void scan(const std::string& filepath, const RowCallback& onRow);
+
+    /**
+     * @brief Sort interned feature names and compute the id remapping
+     * @param firstSeenNames Names indexed by provisional (first-seen) id
+     * @param sortedNames Receives the names in lexicographic order
+     * @return std::vector<FeatureType> Final id of every provisional id
+     */
+    static std::vector<FeatureType> rank_feature_names(
+        const std::vector<std::string>& firstSeenNames,
+        std::vector<std::string>& sortedNames);
+
     /**
      * @brief Load spatial instances from a CSV file
      *
-     * Expects CSV with columns: Feature, Instance, LocX, LocY
+     * Expects CSV with columns: Feature, Instance, LocX, LocY (or X, Y)
      * - Feature: Feature type (e.g., "A", "B", "Restaurant")
      * - Instance: Instance number (integer)
      * - LocX: X coordinate (double)
      * - LocY: Y coordinate (double)
      *
+     * Feature names are interned to dense ids in lexicographic order and every row
+     * gets its row index as instance id. The dictionary keeps the names.
+     *
+     * The file is memory-mapped and parsed in line-aligned byte ranges on numThreads
+     * threads. The result does not depend on the thread count.
+     *
      * @param filepath Path to the CSV file
-     * @return std::vector<SpatialInstance> Vector of loaded spatial instances
-     * @note Instance IDs are generated as: FeatureType + InstanceNumber (e.g., "A1", "B2")
+     * @param numThreads Parser threads
+     * @return SpatialDataset Loaded instances and their feature/instance dictionary
+     * @note Instance names are rebuilt as: FeatureName + InstanceNumber (e.g., "A1", "B2")
+     */
+    static SpatialDataset load_csv(const std::string& filepath, unsigned numThreads = 1);
+
+    /**
+     * @brief Load a CSV file row by row through csv.hpp
+     *
+     * Same result as load_csv. Handles quoted fields, padded or signed numbers and
+     * other delimiters, which the parallel parser leaves to this path.
+     *
+     * @param filepath Path to the CSV file
+     * @return SpatialDataset Loaded instances and their feature/instance dictionary
+     */
+    static SpatialDataset load_csv_reader(const std::string& filepath);
+
+    /**
+     * @brief Load a binary columnar dataset written by convert_csv_to_binary
+     *
+     * The file is memory-mapped; instances are filled straight from the columns
+     * without any parsing. Ids, feature ids and names match load_csv on the source CSV.
+     *
+     * @param filepath Path to the columnar file
+     * @return SpatialDataset Loaded instances and their feature/instance dictionary
+     */
+    static SpatialDataset load_binary(const std::string& filepath);
+
+    /**
+     * @brief Load a dataset in either format (columnar files are recognized by their magic)
+     * @param filepath Path to the CSV or columnar file
+     * @param numThreads Threads used to parse a CSV
+     * @return SpatialDataset Loaded instances and their feature/instance dictionary
+     */
+    static SpatialDataset load(const std::string& filepath, unsigned numThreads = 1);
+
+    /**
+     * @brief Convert a CSV dataset to the binary columnar format
+     * @param csvPath Source CSV file
+     * @param binaryPath Destination file (overwritten)
+     * @return size_t Number of rows written
      */
-    static std::vector<SpatialInstance> load_csv(const std::string& filepath);
+    static size_t convert_csv_to_binary(const std::string& csvPath, const std::string& binaryPath);
 };
\ No newline at end of file
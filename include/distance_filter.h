@@ -0,0 +1,54 @@
+/**
+ * @file distance_filter.h
+ * @brief Batched neighbor test: which candidates lie within the distance threshold
+ *
+ * The AVX2 kernel tests 4 candidates per step on squared distances (no sqrt) together
+ * with a feature-mismatch mask and compress-stores the surviving positions. Candidates
+ * whose squared distance is within a relative 1e-9 of the threshold are re-checked with
+ * the scalar formula, so both kernels accept exactly the same pairs. The kernel is chosen
+ * once at runtime from the CPU features.
+ */
+
+#pragma once
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace distfilter {
+
+	/**
+	 * @brief Implementation of the filter loop
+	 */
+	enum class Kernel {
+		Scalar,  ///< One candidate at a time with sqrt(dx^2 + dy^2)
+		AVX2     ///< 4 candidates per step on squared distances
+	};
+
+	/**
+	 * @brief Candidate points as parallel arrays (positions index all three)
+	 */
+	struct Points {
+		const double* x;
+		const double* y;
+		const FeatureType* feature;
+	};
+
+	// Best kernel supported by this CPU
+	Kernel detectKernel();
+
+	// Kernel currently used by filter()
+	Kernel activeKernel();
+
+	// Force a kernel (benchmarks); returns false and keeps the current one if unsupported
+	bool setKernel(Kernel kernel);
+
+	const char* kernelName(Kernel kernel);
+
+	// Exact neighbor test of two points: |dx|, |dy| and sqrt(dx^2 + dy^2) all <= d
+	bool withinDistance(double ax, double ay, double bx, double by, double d);
+
+	// Positions j in [begin, end), ascending, with a different feature than point i and
+	// withinDistance(i, j). out needs room for end - begin positions. Returns the count.
+	size_t filter(const Points& points, size_t i, size_t begin, size_t end, double d, int32_t* out);
+
+} // namespace distfilter
@@ -0,0 +1,145 @@
+/**
+ * @file feature_bitset.h
+ * @brief Fixed-width bitset over feature ids, used as the colocation key type
+ *
+ * The width is chosen at compile time with COLOCATION_MAX_FEATURES (64, 128 or 256).
+ * Subset tests, membership, size and hashing are a handful of word operations.
+ */
+
+#pragma once
+#include "bit_ops.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+
+#ifndef COLOCATION_MAX_FEATURES
+#define COLOCATION_MAX_FEATURES 64
+#endif
+
+static_assert(COLOCATION_MAX_FEATURES == 64 || COLOCATION_MAX_FEATURES == 128 || COLOCATION_MAX_FEATURES == 256,
+	"COLOCATION_MAX_FEATURES must be 64, 128 or 256");
+
+/**
+ * @brief Set of feature ids stored as Words x 64 bits
+ *
+ * Iterating yields feature ids in ascending order, so the bitset can be used
+ * wherever a sorted std::vector of feature ids was used before. operator< orders
+ * bitsets exactly like the lexicographic order of those sorted vectors.
+ */
+template <size_t Words>
+class FeatureBitset {
+public:
+	static constexpr size_t kCapacity = Words * 64;  ///< Largest feature id + 1 that fits
+
+	using value_type = uint16_t;
+
+	/** @brief Forward iterator over the set feature ids in ascending order */
+	class const_iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = uint16_t;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const uint16_t*;
+		using reference = uint16_t;
+
+		const_iterator(const FeatureBitset* set, int pos) : set(set), pos(pos) {}
+
+		uint16_t operator*() const { return static_cast<uint16_t>(pos); }
+		const_iterator& operator++() { pos = set->nextFrom(pos + 1); return *this; }
+		const_iterator operator++(int) { const_iterator tmp = *this; ++(*this); return tmp; }
+		bool operator==(const const_iterator& o) const { return pos == o.pos; }
+		bool operator!=(const const_iterator& o) const { return pos != o.pos; }
+
+	private:
+		const FeatureBitset* set;
+		int pos;
+	};
+
+	FeatureBitset() : words{} {}
+
+	// --- Element access ---
+	void insert(uint16_t f) { words[f >> 6] |= (uint64_t(1) << (f & 63)); }
+	void erase(uint16_t f) { words[f >> 6] &= ~(uint64_t(1) << (f & 63)); }
+	bool contains(uint16_t f) const { return f < kCapacity && ((words[f >> 6] >> (f & 63)) & 1); }
+	size_t count(uint16_t f) const { return contains(f) ? 1 : 0; }
+
+	// Popcount of all words
+	size_t size() const {
+		size_t n = 0;
+		for (size_t i = 0; i < Words; ++i) n += bits::popcount(words[i]);
+		return n;
+	}
+
+	bool empty() const {
+		for (size_t i = 0; i < Words; ++i) if (words[i]) return false;
+		return true;
+	}
+
+	// True if every feature of this set is also in other
+	bool isSubsetOf(const FeatureBitset& other) const {
+		for (size_t i = 0; i < Words; ++i) if (words[i] & ~other.words[i]) return false;
+		return true;
+	}
+
+	uint64_t word(size_t i) const { return words[i]; }
+
+	const_iterator begin() const { return const_iterator(this, nextFrom(0)); }
+	const_iterator end() const { return const_iterator(this, static_cast<int>(kCapacity)); }
+
+	// --- Comparison ---
+	bool operator==(const FeatureBitset& o) const {
+		for (size_t i = 0; i < Words; ++i) if (words[i] != o.words[i]) return false;
+		return true;
+	}
+	bool operator!=(const FeatureBitset& o) const { return !(*this == o); }
+
+	// Lexicographic order of the ascending feature lists.
+	// Let d be the lowest feature in exactly one of the two sets. Both lists agree
+	// before d; the one holding d is smaller unless the other one ends there.
+	bool operator<(const FeatureBitset& o) const {
+		for (size_t i = 0; i < Words; ++i) {
+			uint64_t diff = words[i] ^ o.words[i];
+			if (!diff) continue;
+			int d = bits::lowestBit(diff);
+			uint64_t above = (d == 63) ? 0 : (~uint64_t(0) << (d + 1));
+			bool thisHasD = (words[i] >> d) & 1;
+			const FeatureBitset& other = thisHasD ? o : *this;
+			bool otherContinues = (other.words[i] & above) != 0;
+			for (size_t j = i + 1; j < Words && !otherContinues; ++j) otherContinues = other.words[j] != 0;
+			return thisHasD ? otherContinues : !otherContinues;
+		}
+		return false;
+	}
+	bool operator>(const FeatureBitset& o) const { return o < *this; }
+	bool operator<=(const FeatureBitset& o) const { return !(o < *this); }
+	bool operator>=(const FeatureBitset& o) const { return !(*this < o); }
+
+	size_t hash() const {
+		uint64_t h = 0x9E3779B97F4A7C15ull;
+		for (size_t i = 0; i < Words; ++i) {
+			h ^= words[i] + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+		}
+		return static_cast<size_t>(h);
+	}
+
+private:
+	uint64_t words[Words];
+
+	// First set bit at position >= from, or kCapacity if none
+	int nextFrom(int from) const {
+		for (size_t i = static_cast<size_t>(from) >> 6; i < Words; ++i) {
+			uint64_t w = words[i];
+			if (i == (static_cast<size_t>(from) >> 6)) w &= ~uint64_t(0) << (from & 63);
+			if (w) return static_cast<int>(i * 64) + bits::lowestBit(w);
+		}
+		return static_cast<int>(kCapacity);
+	}
+};
+
+namespace std {
+	template <size_t Words>
+	struct hash<FeatureBitset<Words>> {
+		size_t operator()(const FeatureBitset<Words>& s) const { return s.hash(); }
+	};
+}
@@ -0,0 +1,98 @@
+/**
+ * @file instance_bitmap.h
+ * @brief Compressed bitmap of instance ids (Roaring-style containers)
+ */
+
+#pragma once
+#include "bit_ops.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Set of 32-bit instance ids stored as compressed containers
+ *
+ * Ids are split by their high 16 bits into containers. Each container holds the low
+ * 16 bits in one of three forms:
+ * - Array:  sorted uint16 values, used up to 4096 values
+ * - Bitmap: 1024 x 64-bit words, used above 4096 values
+ * - Run:    (start, length - 1) pairs, chosen by runOptimize() when it is smallest
+ *
+ * Bitmap unions and cardinalities are plain word loops the compiler vectorizes.
+ */
+class InstanceBitmap {
+public:
+	// Insert one id
+	void add(uint32_t id);
+
+	// Membership test
+	bool contains(uint32_t id) const;
+
+	// Number of ids in the set
+	size_t cardinality() const;
+
+	bool empty() const { return containers.empty(); }
+
+	// In-place union: this = this | other
+	void unionWith(const InstanceBitmap& other);
+
+	// Re-encode each container in its smallest form (array, bitmap or run)
+	void runOptimize();
+
+	// Approximate heap footprint in bytes
+	size_t memoryBytes() const;
+
+	// All ids in ascending order
+	std::vector<uint32_t> toVector() const;
+
+	// Call fn(id) for every id in ascending order
+	template <typename Fn>
+	void forEach(Fn fn) const {
+		for (const auto& c : containers) {
+			uint32_t high = uint32_t(c.key) << 16;
+			if (c.kind == Container::Array) {
+				for (uint16_t v : c.values) fn(high | v);
+			}
+			else if (c.kind == Container::Run) {
+				for (size_t r = 0; r < c.values.size(); r += 2) {
+					uint32_t start = c.values[r];
+					uint32_t last = start + c.values[r + 1];
+					for (uint32_t v = start; v <= last; ++v) fn(high | v);
+				}
+			}
+			else {
+				for (size_t w = 0; w < c.words.size(); ++w) {
+					uint64_t word = c.words[w];
+					while (word) {
+						uint32_t bit = static_cast<uint32_t>(bits::lowestBit(word));
+						fn(high | uint32_t(w * 64 + bit));
+						word &= word - 1;
+					}
+				}
+			}
+		}
+	}
+
+private:
+	static constexpr uint32_t kArrayMax = 4096;    ///< Array container capacity before turning into a bitmap
+	static constexpr uint32_t kAccumulateMax = 512; ///< Union results above this size are kept as bitmaps
+	static constexpr size_t kBitmapWords = 1024;   ///< 65536 bits
+
+	struct Container {
+		enum Kind : uint8_t { Array, Bitmap, Run };
+
+		uint16_t key = 0;            ///< High 16 bits shared by all ids in the container
+		Kind kind = Array;
+		uint32_t card = 0;           ///< Cached cardinality
+		std::vector<uint16_t> values; ///< Array: sorted values; Run: (start, length - 1) pairs
+		std::vector<uint64_t> words;  ///< Bitmap: kBitmapWords words
+	};
+
+	std::vector<Container> containers;  ///< Sorted by key
+
+	// Container for a key, created (empty array) if missing
+	Container& containerFor(uint16_t key);
+
+	static void toBitmap(Container& c);
+	static void unionContainer(Container& dst, const Container& src);
+};
@@ -0,0 +1,42 @@
+/**
+ * @file mapped_file.h
+ * @brief Read-only memory-mapped file (POSIX mmap / Win32 file mapping)
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Maps a whole file read-only for the lifetime of the object
+ *
+ * Pages are loaded by the OS on first touch and shared with the page cache, so
+ * mapping the same file again in a later run costs almost nothing.
+ */
+class MappedFile {
+public:
+	MappedFile() = default;
+
+	// Map path; throws std::runtime_error if it cannot be opened or mapped
+	explicit MappedFile(const std::string& path);
+
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	const char* data() const { return base; }
+	size_t size() const { return length; }
+
+private:
+	const char* base = nullptr;  ///< Start of the mapping (nullptr for empty files)
+	size_t length = 0;           ///< Mapped bytes
+#ifdef _WIN32
+	void* fileHandle = nullptr;     ///< HANDLE from CreateFile
+	void* mappingHandle = nullptr;  ///< HANDLE from CreateFileMapping
+#endif
+
+	void unmap();
+};
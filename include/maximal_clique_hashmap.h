@@ -6,24 +6,63 @@
 #pragma once
 
 #include "types.h"
+#include "clique_sink.h"
 #include <vector>
 #include <unordered_map>
 #include <map>
 #include <set>
 #include <queue>
 
+/**
+ * @brief Core decomposition of the neighbor graph, computed with the degeneracy ordering
+ */
+struct DegeneracyInfo {
+	std::vector<int> coreNumbers;  ///< Core number of each vertex (instance index)
+	int degeneracy = 0;            ///< Largest core number
+};
+
+/**
+ * @brief Counters collected by executeBK
+ */
+struct EnumerationStats {
+	size_t recursionNodes = 0;   ///< Calls of the pivot and RCD recursions
+	size_t heapAllocations = 0;  ///< Heap allocations of the recursion's working storage (arena chunks, R and bit-row regrowth)
+	size_t reportedCliques = 0;  ///< Cliques handed to the sink
+	size_t featureShortcuts = 0; ///< Branches collapsed into one report by the feature-aware mode
+};
+
 /**
  * @brief Class for maximal clique-based hashmap construction
  */
 class MaximalCliqueHashmap {
 private:
+	unsigned numThreads;  ///< Worker threads used by the enumeration (1 = sequential)
+	bool featureAware;    ///< Collapse branches whose cliques all share one feature set
+	DegeneracyInfo degeneracyInfo;  ///< Filled by executeBK
+	EnumerationStats enumerationStats;  ///< Filled by executeBK
+
 	// Execute Bron-Kerbosch algorithm to find maximal cliques
 	// std::vector<std::vector<ColocationInstance>> executeDivBK(const std::vector<NeighborSet>& neighborSets);
 
 public:
-	std::map<Colocation, std::unordered_map<FeatureType, std::set<const SpatialInstance*>>> executeBK(const std::vector<NeighborSet>& neighborSets);
+	explicit MaximalCliqueHashmap(unsigned numThreads = 1, bool featureAware = false)
+		: numThreads(numThreads == 0 ? 1 : numThreads), featureAware(featureAware) {}
+
+	// Enumerate maximal cliques of the CSR neighbor graph and hand each one to sink
+	// (forked per worker thread, joined and finished before returning)
+	void enumerate(const CSRGraph& graph, CliqueSink& sink);
+
+	// Enumerate maximal cliques of the CSR neighbor graph and group their instances by colocation
+	CliqueHashMap executeBK(const CSRGraph& graph);
+
+	// Core numbers and degeneracy of the graph passed to the last executeBK call
+	const DegeneracyInfo& getDegeneracyInfo() const { return degeneracyInfo; }
+
+	// Recursion and allocation counters of the last executeBK call.
+	// heapAllocations stays bounded by the arena growth, independent of recursionNodes.
+	const EnumerationStats& getEnumerationStats() const { return enumerationStats; }
 
 	// Extract initial candidate colocations from hashmap
 	std::priority_queue<Colocation, std::vector<Colocation>, ColocationPriorityComp> extractInitialCandidates(
-		const std::map<Colocation, std::unordered_map<FeatureType, std::set<const SpatialInstance*>>>& hashMap);
+		const CliqueHashMap& hashMap);
 };
\ No newline at end of file
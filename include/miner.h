@@ -5,42 +5,119 @@
 
 #pragma once
 #include "types.h"
+#include "superset_index.h"
+#include "utils.h"
 #include <set>
 #include <map>
 #include <unordered_map>
 #include <queue>
 #include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A colocation pattern with its weighted participation index
+ */
+struct ScoredColocation {
+	Colocation pattern;  ///< Feature set of the pattern
+	double weightedPI;   ///< Weighted participation index
+};
+
+/**
+ * @brief Participation ratio PR(f, C) of every feature of a pattern, in ascending feature order
+ */
+using ParticipationMap = std::unordered_map<Colocation, std::vector<double>>;
 
 /**
  * @brief Class for mining prevalent colocation patterns
  */
 class Miner {
 private:
-	// Query instances of a colocation from hashmap
-	std::map<FeatureType, std::set<const SpatialInstance*>> queryInstances(
-		Colocation c,
-		const std::map<Colocation, std::unordered_map<FeatureType, std::set<const SpatialInstance*>>>& hashMap);
+	unsigned numThreads;          ///< Threads evaluating a candidate level (1 = sequential queue walk)
+	bool recordParticipation;     ///< Keep the participation ratios of reported patterns
+	ParticipationMap participation;  ///< Participation ratios of reported patterns (rule generation)
+	SupersetIndex supersetIndex;  ///< Index over the hashmap keys
+	std::vector<const FeatureInstanceMap*> cliqueInstances;  ///< Hashmap value of each indexed key
+	WeightTable weights;          ///< Feature counts and W_log table of the mined dataset
+	std::vector<double> pairRatios;  ///< Top-K bounds: PR(a) in {a, b} by [a * numFeatures + b]
+
+	// Index the hashmap keys so queryInstances only visits supersets
+	void buildIndex(const CliqueHashMap& hashMap);
+
+	// Query instances of a colocation from the indexed hashmap
+	std::map<FeatureType, InstanceBitmap> queryInstances(const Colocation& c);
+
+	// Query instances of c = parent minus one feature, starting from the parent's result.
+	// Every key containing parent contains c, so this holds whether the parent was
+	// prevalent or not; only the keys with c but without parent's extra feature are added
+	std::map<FeatureType, InstanceBitmap> queryInstances(
+		const Colocation& c,
+		const Colocation& parent,
+		const std::map<FeatureType, InstanceBitmap>& parentInstances);
 
 	// Compute weighted participation index for a colocation
 	double computeWeightedPI(
-		const std::map<FeatureType, std::set<const SpatialInstance*>>& partInstances,
-		Colocation c,
-		const std::unordered_map<FeatureType, double>& rareIntensityMap,
-		const std::map<FeatureType, int>& featureCounts);
+		const std::map<FeatureType, InstanceBitmap>& partInstances,
+		const Colocation& c) const;
+
+	// PR of every feature of c from its participating instances
+	std::vector<double> participationRatios(
+		const std::map<FeatureType, InstanceBitmap>& partInstances,
+		const Colocation& c) const;
 
 	// Generate all size-1 subsets of a colocation
-	std::set<Colocation> generateSubsets(const Colocation& c);
+	std::vector<Colocation> generateSubsets(const Colocation& c);
 
 	// Deduce prevalent subsets using downward closure property
-	std::set<Colocation> deducePrevalentSubsets(std::set<Colocation>& subsets, const Colocation& c, const std::map<FeatureType, int>& featureCounts);
+	std::vector<Colocation> deducePrevalentSubsets(const std::vector<Colocation>& subsets, const Colocation& c) const;
+
+	// Participation ratio of every feature in every size-2 pattern (Top-K bounds);
+	// returns the scored size-2 patterns
+	std::vector<ScoredColocation> buildPairRatios();
+
+	// Upper bound of the weighted PI of c
+	double candidateBound(const Colocation& c) const;
+
+	// Upper bound of the weighted PI of every subset of c with at least two features
+	double subsetBound(const Colocation& c) const;
+
+	// Level-synchronous variant of minePCPs: all size-k candidates are evaluated in parallel
+	std::set<Colocation> minePCPsByLevel(
+		std::priority_queue<Colocation, std::vector<Colocation>, ColocationPriorityComp>& candidateColocations,
+		double min_prev);
+
+	// Record the ratios of the subsets deduced prevalent from a frontier (rule generation)
+	void recordDeducedRatios(
+		const std::map<Colocation, size_t>& deducedBy,
+		const std::map<Colocation, size_t>& nextLevel,
+		const std::vector<Colocation>& frontier,
+		const std::vector<std::map<FeatureType, InstanceBitmap>>& frontierInstances);
 
 public:
+	// recordParticipation keeps the participation ratios of every reported pattern
+	explicit Miner(unsigned numThreads = 1, bool recordParticipation = false)
+		: numThreads(numThreads == 0 ? 1 : numThreads), recordParticipation(recordParticipation) {}
+
+	// Participation ratios of the patterns reported by the last mining call
+	// (empty unless recordParticipation was set)
+	const ParticipationMap& patternParticipation() const { return participation; }
+
 	// Mine prevalent colocation patterns (main algorithm)
 	std::set<Colocation> minePCPs(
 		std::priority_queue<Colocation, std::vector<Colocation>, ColocationPriorityComp>& candidateColocations,
-		const std::map<Colocation, std::unordered_map<FeatureType, std::set<const SpatialInstance*>>>& hashMap,
+		const CliqueHashMap& hashMap,
 		const std::map<FeatureType, int>& featureCounts,
 		double delta,
 		double min_prev
 	);
+
+	// Mine the k patterns with the highest weighted PI (at least min_prev), best first.
+	// The threshold rises to the k-th best score found so far and prunes the lattice walk.
+	std::vector<ScoredColocation> mineTopK(
+		std::priority_queue<Colocation, std::vector<Colocation>, ColocationPriorityComp>& candidateColocations,
+		const CliqueHashMap& hashMap,
+		const std::map<FeatureType, int>& featureCounts,
+		double delta,
+		double min_prev,
+		size_t k
+	);
 };
\ No newline at end of file
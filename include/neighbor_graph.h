@@ -5,24 +5,55 @@
 
 #pragma once
 #include "types.h"
+#include <cstdint>
+#include <string>
+#include <utility>
 #include <vector>
 
+/**
+ * @brief Strategy used to enumerate neighbor pairs
+ */
+enum class NeighborSearchMethod {
+	PlaneSweep,  ///< Sort by X and scan forward while the X gap is within the threshold
+	Grid         ///< Bucket instances into cells of size threshold and scan the 3x3 cell block
+};
+
+/**
+ * @brief Parse a neighbor search method name ("sweep" or "grid")
+ * @return NeighborSearchMethod Parsed method, PlaneSweep for unknown names
+ */
+NeighborSearchMethod parseNeighborSearchMethod(const std::string& name);
+
 /**
  * @brief Class for building spatial neighbor graphs
  */
 class NeighborGraph {
 private:
-	// Calculate Euclidean distance between two instances
-	double euclideanDist(const SpatialInstance& a, const SpatialInstance& b);
+	/** @brief Neighbor pairs (instance indices) found by one work chunk */
+	using PairBuffer = std::vector<std::pair<int32_t, int32_t>>;
 
-	// Find all neighbor pairs within distance threshold
-	std::vector<std::pair<SpatialInstance, SpatialInstance>> findNeighborPair(
-		const std::vector<SpatialInstance>& instances,
+	unsigned numThreads;  ///< Worker threads used by the pair search
+
+	// Number of work chunks used to split n sweep rows or grid cells
+	size_t numChunksFor(size_t n) const;
+
+	// Find all neighbor pairs within distance threshold (plane sweep on X)
+	std::vector<PairBuffer> findNeighborPair(
+		const InstanceTable& instances,
+		double distanceThreshold);
+
+	// Find all neighbor pairs within distance threshold (uniform grid, cell size = threshold)
+	std::vector<PairBuffer> findNeighborPairGrid(
+		const InstanceTable& instances,
 		double distanceThreshold);
 
 public:
+	explicit NeighborGraph(unsigned numThreads = 1) : numThreads(numThreads == 0 ? 1 : numThreads) {}
+
 	// Build neighbor graph: for each instance, find all neighbors within threshold
-	std::vector<NeighborSet> buildNeighborGraph(
-		const std::vector<SpatialInstance>& instances,
-		double distanceThreshold);
-};
\ No newline at end of file
+	// The returned graph refers to instances, which must outlive it
+	CSRGraph buildNeighborGraph(
+		const InstanceTable& instances,
+		double distanceThreshold,
+		NeighborSearchMethod method = NeighborSearchMethod::Grid);
+};
@@ -0,0 +1,60 @@
+/**
+ * @file parallel.h
+ * @brief Minimal thread helpers for data-parallel stages
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Resolve the configured thread count
+ * @param requested Number of threads from the configuration (0 = all hardware threads)
+ * @return unsigned Number of worker threads to use (at least 1)
+ */
+inline unsigned resolveThreadCount(int requested) {
+	if (requested > 0) return static_cast<unsigned>(requested);
+	unsigned hw = std::thread::hardware_concurrency();
+	return hw > 0 ? hw : 1;
+}
+
+/**
+ * @brief Split [0, n) into numChunks contiguous ranges and run them on a thread pool
+ *
+ * fn(chunk, begin, end) is called once per chunk. Chunk c always covers the same
+ * range for a given (n, numChunks), so callers that keep one output buffer per chunk
+ * and concatenate them in chunk order get a deterministic result. Threads claim the
+ * next unprocessed chunk from a shared counter, so uneven chunks balance themselves.
+ *
+ * @param n Number of work items
+ * @param numChunks Number of chunks (and output buffers) to create
+ * @param numThreads Maximum number of threads running at once
+ * @param fn Callable taking (size_t chunk, size_t begin, size_t end)
+ */
+template <typename Fn>
+void parallelForChunks(size_t n, size_t numChunks, unsigned numThreads, Fn fn) {
+	if (numChunks == 0) return;
+	auto chunkBegin = [&](size_t c) { return n * c / numChunks; };
+
+	if (numThreads <= 1 || numChunks == 1) {
+		for (size_t c = 0; c < numChunks; ++c) fn(c, chunkBegin(c), chunkBegin(c + 1));
+		return;
+	}
+
+	// Dynamic schedule: each thread takes the next chunk nobody has started yet
+	unsigned workers = static_cast<unsigned>(std::min<size_t>(numThreads, numChunks));
+	std::atomic<size_t> nextChunk{ 0 };
+	std::vector<std::thread> pool;
+	pool.reserve(workers);
+	for (unsigned t = 0; t < workers; ++t) {
+		pool.emplace_back([&]() {
+			for (size_t c = nextChunk.fetch_add(1); c < numChunks; c = nextChunk.fetch_add(1)) {
+				fn(c, chunkBegin(c), chunkBegin(c + 1));
+			}
+			});
+	}
+	for (auto& th : pool) th.join();
+}
@@ -0,0 +1,41 @@
+/**
+ * @file rule_generator.h
+ * @brief Colocation rules derived from prevalent patterns
+ */
+
+#pragma once
+#include "types.h"
+#include "miner.h"
+#include <vector>
+
+/**
+ * @brief Colocation rule antecedent -> consequent, both parts of one prevalent pattern
+ */
+struct ColocationRule {
+	Colocation antecedent;         ///< Feature on the left-hand side
+	Colocation consequent;         ///< Remaining features of the pattern
+	double conditionalProbability; ///< cp(antecedent -> consequent)
+};
+
+/**
+ * @brief Generates colocation rules from mined patterns
+ *
+ * Rules have a single-feature antecedent: cp({f} -> C \ {f}) = PR(f, C), the share of
+ * f's instances that take part in a row instance of C. The ratios come from the miner,
+ * so no hashmap scan is needed. Multi-feature antecedents would need the row instances
+ * of the antecedent itself, which the miner does not keep, so they are not generated.
+ */
+class RuleGenerator {
+private:
+	unsigned numThreads;  ///< Threads generating rules (patterns are split into chunks)
+
+public:
+	explicit RuleGenerator(unsigned numThreads = 1) : numThreads(numThreads == 0 ? 1 : numThreads) {}
+
+	// All rules with cp >= minCondProb, in pattern order; patterns missing from
+	// participation produce no rules
+	std::vector<ColocationRule> generate(
+		const std::vector<Colocation>& patterns,
+		const ParticipationMap& participation,
+		double minCondProb) const;
+};
@@ -0,0 +1,45 @@
+/**
+ * @file set_ops.h
+ * @brief Intersection / difference primitives on sorted 32-bit id lists
+ *
+ * The block-compare kernels (SSE4.2: 4 x 4 ids, AVX2: 8 x 8 ids) are chosen once at
+ * runtime from the CPU features, with a scalar merge as fallback. Very skewed inputs
+ * are handled by galloping (exponential search) over the longer list.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace setops {
+
+	/**
+	 * @brief Implementation of the block-compare path
+	 */
+	enum class Kernel {
+		Scalar,  ///< Branchy two-pointer merge
+		SSE42,   ///< 4 x 4 all-pairs compare with 128-bit registers
+		AVX2     ///< 8 x 8 all-pairs compare with 256-bit registers
+	};
+
+	// Best kernel supported by this CPU
+	Kernel detectKernel();
+
+	// Kernel currently used by the functions below
+	Kernel activeKernel();
+
+	// Force a kernel (benchmarks); returns false and keeps the current one if unsupported
+	bool setKernel(Kernel kernel);
+
+	const char* kernelName(Kernel kernel);
+
+	// |A n B|
+	size_t intersectCount(const int32_t* a, size_t na, const int32_t* b, size_t nb);
+
+	// out = A n B (ascending); out needs room for min(na, nb) ids. Returns the size.
+	size_t intersect(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out);
+
+	// out = A \ B (ascending); out needs room for na ids. Returns the size.
+	size_t difference(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out);
+
+} // namespace setops
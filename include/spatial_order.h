@@ -0,0 +1,43 @@
+/**
+ * @file spatial_order.h
+ * @brief Renumbering of instances along a space-filling curve
+ */
+
+#pragma once
+#include "types.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Space-filling curve used to renumber instances
+ */
+enum class ReorderMethod {
+	None,     ///< Keep dataset (file) order
+	Morton,   ///< Z-order: interleaved coordinate bits
+	Hilbert   ///< Hilbert curve: no long jumps between consecutive cells
+};
+
+/**
+ * @brief Parse a reorder method name ("none", "morton" or "hilbert")
+ * @return ReorderMethod Parsed method, None for unknown names
+ */
+ReorderMethod parseReorderMethod(const std::string& name);
+
+/**
+ * @brief Order of the instances along a curve
+ *
+ * Coordinates are scaled to 32-bit integers over the bounding box. Instances with the
+ * same curve key keep their relative dataset order.
+ *
+ * @return std::vector<InstanceID> order[k] = current id of the instance placed at position k
+ */
+std::vector<InstanceID> spatialOrder(const InstanceTable& instances, ReorderMethod method);
+
+/**
+ * @brief Renumber a dataset so that instance k is the old instance order[k]
+ *
+ * Table columns and the instance-number dictionary move together, so instance names
+ * in the output are unchanged. Afterwards instances.id[k] == k again.
+ */
+void applyOrder(SpatialDataset& dataset, const std::vector<InstanceID>& order);
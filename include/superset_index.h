@@ -0,0 +1,47 @@
+/**
+ * @file superset_index.h
+ * @brief Inverted feature index over maximal-clique colocation keys
+ */
+
+#pragma once
+#include "types.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Answers "all keys that are supersets of C" without scanning every key
+ *
+ * Every key is posted under each feature it contains and under each pair of
+ * features it contains. Candidates mined by minePCPs always have at least two
+ * features, so a query walks the shortest pair posting list among the feature
+ * pairs of C and keeps the keys that contain the rest of C (one bitset subset
+ * test per key).
+ *
+ * query(C, r) answers "supersets of C without feature r": positions posted under
+ * r are dropped by a sorted difference before any key is read.
+ */
+class SupersetIndex {
+private:
+	std::vector<Colocation> keys;                                     ///< Indexed keys, addressed by position
+	std::vector<std::vector<uint32_t>> postings;                      ///< postings[f] = positions of keys containing f
+	std::unordered_map<uint32_t, std::vector<uint32_t>> pairPostings; ///< (f << 16 | g), f < g -> positions of keys containing both
+
+	static uint32_t pairKey(FeatureType f, FeatureType g) { return (uint32_t(f) << 16) | g; }
+
+	// Shortest posting list among the features and feature pairs of c (c not empty)
+	const std::vector<uint32_t>& shortestPosting(const Colocation& c) const;
+
+public:
+	// Index keys; key i of the input is reported as position i by query()
+	void build(const std::vector<Colocation>& keys);
+
+	// Positions of all indexed keys that contain every feature of c, in ascending order
+	std::vector<uint32_t> query(const Colocation& c) const;
+
+	// Positions of the keys that contain every feature of c but not excluded, in ascending order
+	std::vector<uint32_t> query(const Colocation& c, FeatureType excluded) const;
+
+	size_t size() const { return keys.size(); }
+	const Colocation& key(uint32_t pos) const { return keys[pos]; }
+};
@@ -0,0 +1,60 @@
+/**
+ * @file tiled_executor.h
+ * @brief Out-of-core tiled neighbor search and clique enumeration
+ */
+
+#pragma once
+#include "types.h"
+#include "neighbor_graph.h"
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Everything the mining stage needs, produced without loading the whole dataset
+ */
+struct TiledResult {
+	CliqueHashMap hashMap;                     ///< Merged participating-instance bitmaps
+	std::vector<std::string> featureNames;     ///< Feature names in id (lexicographic) order
+	std::map<FeatureType, int> featureCounts;  ///< Instances per feature
+	size_t numInstances = 0;                   ///< Rows in the dataset
+	size_t numTiles = 0;                       ///< Non-empty tiles processed
+	size_t maxTileInstances = 0;               ///< Largest tile including its halo
+};
+
+/**
+ * @brief Runs neighbor search and clique enumeration tile by tile
+ *
+ * Space is cut into square tiles of side tileSize. Each tile is processed with a
+ * halo of distanceThreshold around it, so every clique whose lowest-id instance lies
+ * in the tile is complete (and equally maximal) in the tile's local graph. That tile
+ * owns the clique; the other tiles that see it drop it.
+ *
+ * The dataset is streamed twice (DataLoader::scan): once for the bounding box and
+ * feature dictionary, once to bucket rows into per-tile files. A row goes to every tile
+ * whose halo covers it; a fixed row budget caps what is buffered over all tiles. Tiles
+ * are then loaded one at a time and each clique hashmap goes to a file in key order.
+ * The files are k-way merged on disk, so every key reaches memory complete and is
+ * compressed at once. Instance ids are row indices, as with DataLoader::load.
+ *
+ * Until the merge, memory follows the largest tile with its halo plus fixed buffers;
+ * small tiles cost time (more halo rows, more files), not memory. The merged hashmap
+ * itself and the mining after it need as much as in the in-memory mode, so a run is
+ * only bounded by the tile size when the hashmap is small next to the instances.
+ * Columnar files are mapped, and their pages count as resident while scanned.
+ */
+class TiledExecutor {
+private:
+	double tileSize;
+	double distanceThreshold;
+	unsigned numThreads;
+	std::string workDir;  ///< Directory for bucket and result files (created, then emptied)
+
+public:
+	TiledExecutor(double tileSize, double distanceThreshold, unsigned numThreads, const std::string& workDir)
+		: tileSize(tileSize), distanceThreshold(distanceThreshold),
+		numThreads(numThreads == 0 ? 1 : numThreads), workDir(workDir) {}
+
+	// Process a dataset (CSV or columnar) tile by tile
+	TiledResult run(const std::string& datasetPath, NeighborSearchMethod method);
+};
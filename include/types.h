@@ -7,22 +7,44 @@
  */
 
 #pragma once
+#include "feature_bitset.h"
+#include "instance_bitmap.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
  // ============================================================================
  // Type Aliases
  // ============================================================================
 
- /** @brief Type alias for feature types (e.g., "Restaurant", "Hotel") */
-using FeatureType = std::string;
+ /**
+  * @brief Type alias for feature types
+  *
+  * Dense id into FeatureDictionary::featureNames. Ids are assigned in lexicographic
+  * order of the feature names, so sorting ids sorts names.
+  */
+using FeatureType = std::uint16_t;
 
-/** @brief Type alias for instance identifiers (e.g., "A1", "B2") */
-using InstanceID = std::string;
+/** @brief Type alias for instance identifiers (row index of the instance in the dataset) */
+using InstanceID = std::uint32_t;
 
-/** @brief Type alias for a colocation pattern (set of feature types) */
-using Colocation = std::vector<FeatureType>;
+/**
+ * @brief Type alias for a colocation pattern (set of feature types)
+ *
+ * Fixed-width bitset over feature ids; width selected by COLOCATION_MAX_FEATURES.
+ */
+using Colocation = FeatureBitset<COLOCATION_MAX_FEATURES / 64>;
+
+/** @brief Participating instances of each feature of a colocation */
+using FeatureInstanceMap = std::unordered_map<FeatureType, InstanceBitmap>;
+
+/** @brief Maximal-clique hashmap: colocation key -> participating instances per feature */
+using CliqueHashMap = std::map<Colocation, FeatureInstanceMap>;
 
 /** @brief Type alias for a colocation instance (set of spatial instance pointers) */
 using ColocationInstance = std::vector<const struct SpatialInstance*>;
@@ -37,20 +59,178 @@ using ColocationInstance = std::vector<const struct SpatialInstance*>;
  * Each spatial instance has a feature type, unique identifier, and 2D coordinates.
  */
 struct SpatialInstance {
-    FeatureType type;  ///< Feature type of this instance (e.g., "A", "B")
-    InstanceID id;     ///< Unique identifier (e.g., "A1", "B2")
+    FeatureType type;  ///< Feature id of this instance
+    InstanceID id;     ///< Row index of this instance in the dataset
     double x, y;       ///< 2D spatial coordinates
 };
 
 /**
- * @brief Structure representing a star neighborhood
+ * @brief One column of the instance table: owned storage, or a read-only view
  *
- * A star neighborhood consists of a center instance and all its neighboring instances
- * within the distance threshold.
+ * CSV loaders and reordering fill owned storage; the columnar loader points the
+ * column straight into the mapped file. Reads go through data() either way.
+ * Any mutating call first copies a view into owned storage.
  */
-struct NeighborSet {
-    const SpatialInstance* center;                      ///< Center instance
-    std::vector<const SpatialInstance*> neighbors;      ///< All neighbors within distance threshold
+template <typename T>
+class Column {
+public:
+    Column() = default;
+    Column(const Column& other) { *this = other; }
+    Column(Column&& other) noexcept { *this = std::move(other); }
+
+    Column& operator=(const Column& other) {
+        if (this != &other) {
+            storage = other.storage;
+            adopt(other);
+        }
+        return *this;
+    }
+
+    Column& operator=(Column&& other) noexcept {
+        if (this != &other) {
+            bool view = other.isView();
+            storage = std::move(other.storage);
+            if (view) { ptr = other.ptr; count = other.count; }
+            else sync();
+            other.storage.clear();
+            other.sync();
+        }
+        return *this;
+    }
+
+    const T* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+
+    /** @brief True when the column points into memory it does not own */
+    bool isView() const { return count != 0 && ptr != storage.data(); }
+
+    /** @brief Point at n external values (the caller keeps them alive) */
+    void setView(const T* values, size_t n) {
+        std::vector<T>().swap(storage);
+        ptr = values;
+        count = n;
+    }
+
+    /** @brief Writable values (copies a view into owned storage first) */
+    T* mutableData() { detach(); return storage.data(); }
+
+    void reserve(size_t n) { detach(); storage.reserve(n); sync(); }
+    void resize(size_t n) { detach(); storage.resize(n); sync(); }
+    void push_back(const T& value) { detach(); storage.push_back(value); sync(); }
+
+    /** @brief Drop the values (owned storage is freed) */
+    void release() {
+        std::vector<T>().swap(storage);
+        sync();
+    }
+
+private:
+    std::vector<T> storage;  ///< Owned values (empty for a view)
+    const T* ptr = nullptr;  ///< First value (storage.data() or the viewed memory)
+    size_t count = 0;        ///< Number of values
+
+    void sync() { ptr = storage.data(); count = storage.size(); }
+
+    // After storage was copied from other: follow it, or share other's view
+    void adopt(const Column& other) {
+        if (other.isView()) { ptr = other.ptr; count = other.count; }
+        else sync();
+    }
+
+    void detach() {
+        if (isView()) {
+            storage.assign(ptr, ptr + count);
+            sync();
+        }
+    }
+};
+
+/**
+ * @brief Instances in struct-of-arrays form (the in-memory representation of a dataset)
+ *
+ * Entry i has feature id feature[i], coordinates (x[i], y[i]) and dataset row id[i].
+ * Distance kernels stream the coordinate arrays without pulling the other columns
+ * into cache. SpatialInstance records are only built on demand with instance(i).
+ */
+struct InstanceTable {
+    Column<double> x;                     ///< X coordinates
+    Column<double> y;                     ///< Y coordinates
+    Column<FeatureType> feature;          ///< Feature id of each entry
+    Column<InstanceID> id;                ///< Dataset row of each entry
+    std::shared_ptr<const void> backing;  ///< Mapped file the columns view (null when they own their values)
+
+    size_t size() const { return feature.size(); }
+    bool empty() const { return feature.empty(); }
+
+    void reserve(size_t n) {
+        x.reserve(n); y.reserve(n); feature.reserve(n); id.reserve(n);
+    }
+
+    void resize(size_t n) {
+        x.resize(n); y.resize(n); feature.resize(n); id.resize(n);
+    }
+
+    void push_back(const SpatialInstance& instance) {
+        x.push_back(instance.x);
+        y.push_back(instance.y);
+        feature.push_back(instance.type);
+        id.push_back(instance.id);
+    }
+
+    /** @brief Entry i as a record */
+    SpatialInstance instance(size_t i) const { return { feature[i], id[i], x[i], y[i] }; }
+
+    /** @brief Free the coordinates once only features and ids are read (size is unchanged) */
+    void releaseCoordinates() {
+        x.release();
+        y.release();
+    }
+};
+
+/**
+ * @brief Dictionary turning interned ids back into dataset names
+ *
+ * Built once by the data loader. Only used when results are written.
+ */
+struct FeatureDictionary {
+    std::vector<std::string> featureNames;  ///< featureNames[f] = name of feature id f (e.g., "A")
+    std::vector<int> instanceNumbers;       ///< instanceNumbers[id] = "Instance" column of row id
+
+    const std::string& featureName(FeatureType f) const { return featureNames[f]; }
+
+    /** @brief Original instance name: FeatureName + InstanceNumber (e.g., "A1", "B2") */
+    std::string instanceName(const SpatialInstance& instance) const {
+        return featureNames[instance.type] + std::to_string(instanceNumbers[instance.id]);
+    }
+};
+
+/**
+ * @brief Loaded dataset: interned instances plus the dictionary to name them
+ */
+struct SpatialDataset {
+    InstanceTable instances;                 ///< Instances, instances.id[i] == i
+    FeatureDictionary dictionary;            ///< Names for feature and instance ids
+};
+
+/**
+ * @brief Spatial neighbor graph in compressed sparse row (CSR) form
+ *
+ * Vertex u is entry u of instances. Its neighbors are neighbors[offsets[u] .. offsets[u + 1]),
+ * sorted in ascending id order.
+ */
+struct CSRGraph {
+    const InstanceTable* instances = nullptr;                 ///< Instances the vertex ids refer to
+    std::vector<size_t> offsets;                              ///< Row offsets (numVertices + 1 entries)
+    std::vector<int32_t> neighbors;                           ///< Concatenated sorted neighbor rows
+
+    size_t numVertices() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    const int32_t* rowBegin(int32_t u) const { return neighbors.data() + offsets[u]; }
+    const int32_t* rowEnd(int32_t u) const { return neighbors.data() + offsets[u + 1]; }
+    size_t degree(int32_t u) const { return offsets[u + 1] - offsets[u]; }
 };
 
 /**
@@ -18,13 +18,35 @@
 // ============================================================================
 
 // Count instances per feature type and sort by frequency
-std::map<FeatureType, int> countFeatures(const std::vector<SpatialInstance>& instances);
+std::map<FeatureType, int> countFeatures(const InstanceTable& instances);
 
 // Calculate dispersion (delta) from feature distribution
 double calculateDispersion(const std::map<FeatureType, int>& featureCount);
 
-// Calculate rare intensity for each instance in a colocation
-std::unordered_map<FeatureType, double> calcRareIntensity(
-	Colocation c,
+// ============================================================================
+// Precomputed weights
+// ============================================================================
+
+/**
+ * @brief Weights of the weighted participation index, precomputed per feature id
+ *
+ * RI(f) inside a colocation only depends on N(f), N(f_min) and delta, so
+ * W_log = 1 / RI is tabulated once for every (f_min, f) pair. Evaluating a
+ * candidate then needs no hashing, no allocation and no exp/log calls.
+ */
+struct WeightTable {
+	size_t numFeatures = 0;         ///< Largest feature id + 1
+	std::vector<int> counts;        ///< N(f) by feature id, 0 for absent features
+	std::vector<double> weights;    ///< W_log by [f_min * numFeatures + f]
+
+	// N(f), 0 if f is not in the table
+	int count(FeatureType f) const { return f < numFeatures ? counts[f] : 0; }
+
+	// W_log of f in a colocation whose rarest feature is fMin
+	double weight(FeatureType fMin, FeatureType f) const { return weights[fMin * numFeatures + f]; }
+};
+
+// Build the weight table: W_log = 1 / RI, RI = exp(-(ln N(f) - ln N(f_min))^2 / (2 delta^2))
+WeightTable buildWeightTable(
 	const std::map<FeatureType, int>& featureCounts,
 	double delta);
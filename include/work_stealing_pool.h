@@ -0,0 +1,66 @@
+/**
+ * @file work_stealing_pool.h
+ * @brief Thread pool with per-worker task deques and work stealing
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Work-stealing thread pool for irregular recursive workloads
+ *
+ * Every worker owns a deque. A task submitted from inside a worker goes to the back
+ * of that worker's deque and is popped LIFO by its owner (depth-first, cache-warm).
+ * Idle workers steal from the front of other deques (the oldest, usually largest
+ * tasks). Tasks receive the index of the worker running them, so callers can keep
+ * one output buffer per worker without locking.
+ */
+class WorkStealingPool {
+public:
+	/** @brief Task body; the argument is the index of the executing worker */
+	using Task = std::function<void(unsigned worker)>;
+
+	explicit WorkStealingPool(unsigned numThreads);
+	~WorkStealingPool();
+
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	// Queue a task: onto the caller's deque from a worker, round-robin otherwise
+	void submit(Task task);
+
+	// Block until every submitted task (including tasks they spawned) has finished
+	void wait();
+
+	unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+	struct WorkerQueue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+	std::vector<std::thread> workers;
+
+	std::atomic<size_t> pending{ 0 };      ///< Submitted but not yet finished tasks
+	std::atomic<size_t> queued{ 0 };       ///< Tasks sitting in a deque (raised under idleMutex)
+	std::atomic<unsigned> nextQueue{ 0 };  ///< Round-robin target for external submits
+	std::atomic<bool> stopping{ false };
+
+	std::mutex idleMutex;
+	std::condition_variable workAvailable;
+	std::condition_variable allDone;
+
+	void workerLoop(unsigned index);
+	bool popLocal(unsigned index, Task& task);
+	bool steal(unsigned thief, Task& task);
+};
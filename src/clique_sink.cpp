@@ -0,0 +1,151 @@
+/**
+ * @file clique_sink.cpp
+ * @brief Implementation: Clique sinks (hashmap, counting, spill-to-disk, miner)
+ */
+
+#include "clique_sink.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+	const char kSpillMagic[4] = { 'C', 'L', 'Q', '1' };
+}
+
+// ============================================================================
+// HashmapSink
+// ============================================================================
+
+void HashmapSink::onClique(const int32_t* vertices, size_t count) {
+	Colocation colocationKey;
+	for (size_t i = 0; i < count; ++i) {
+		colocationKey.insert(instances.feature[vertices[i]]);
+	}
+
+	auto& innerMap = (*target)[colocationKey];
+	for (size_t i = 0; i < count; ++i) {
+		innerMap[instances.feature[vertices[i]]].add(instances.id[vertices[i]]);
+	}
+}
+
+std::unique_ptr<CliqueSink> HashmapSink::fork() {
+	std::unique_ptr<HashmapSink> worker(new HashmapSink(instances, *target));
+	worker->target = &worker->owned;
+	return worker;
+}
+
+// Merge the worker's map into ours (bitmap union per feature)
+void HashmapSink::join(CliqueSink& worker) {
+	auto& other = static_cast<HashmapSink&>(worker);
+	for (auto& entry : *other.target) {
+		auto& innerMap = (*target)[entry.first];
+		for (auto& featureInstances : entry.second) {
+			innerMap[featureInstances.first].unionWith(featureInstances.second);
+		}
+	}
+	CliqueHashMap().swap(*other.target);
+}
+
+void HashmapSink::finish() {
+	for (auto& entry : *target) {
+		for (auto& featureInstances : entry.second) {
+			featureInstances.second.runOptimize();
+		}
+	}
+}
+
+// ============================================================================
+// CountingSink
+// ============================================================================
+
+void CountingSink::onClique(const int32_t*, size_t count) {
+	++cliques;
+	vertices += count;
+	maxSize = std::max(maxSize, count);
+}
+
+std::unique_ptr<CliqueSink> CountingSink::fork() {
+	return std::unique_ptr<CliqueSink>(new CountingSink());
+}
+
+void CountingSink::join(CliqueSink& worker) {
+	auto& other = static_cast<CountingSink&>(worker);
+	cliques += other.cliques;
+	vertices += other.vertices;
+	maxSize = std::max(maxSize, other.maxSize);
+}
+
+// ============================================================================
+// SpillSink
+// ============================================================================
+
+SpillSink::SpillSink(const std::string& path) : shared(std::make_shared<SharedFile>()) {
+	shared->out.open(path, std::ios::binary | std::ios::trunc);
+	if (!shared->out.is_open()) {
+		std::cerr << "Cannot open spill file " << path << " for writing.\n";
+		return;
+	}
+	shared->out.write(kSpillMagic, sizeof(kSpillMagic));
+	shared->bytes = sizeof(kSpillMagic);
+}
+
+SpillSink::~SpillSink() {
+	flush();
+}
+
+void SpillSink::onClique(const int32_t* vertices, size_t count) {
+	buffer.push_back(static_cast<int32_t>(count));
+	buffer.insert(buffer.end(), vertices, vertices + count);
+	if (buffer.size() >= kFlushWords) flush();
+}
+
+std::unique_ptr<CliqueSink> SpillSink::fork() {
+	return std::unique_ptr<CliqueSink>(new SpillSink(shared));
+}
+
+void SpillSink::join(CliqueSink& worker) {
+	static_cast<SpillSink&>(worker).flush();
+}
+
+void SpillSink::finish() {
+	flush();
+	if (shared && shared->out.is_open()) shared->out.flush();
+}
+
+// Append the buffered records to the shared file
+void SpillSink::flush() {
+	if (buffer.empty() || !isOpen()) return;
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	size_t bytes = buffer.size() * sizeof(int32_t);
+	shared->out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(bytes));
+	shared->bytes += bytes;
+	buffer.clear();
+}
+
+bool replaySpill(const std::string& path, CliqueSink& sink) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in.is_open()) {
+		std::cerr << "Cannot open spill file " << path << "\n";
+		return false;
+	}
+
+	char magic[sizeof(kSpillMagic)];
+	if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kSpillMagic, sizeof(magic)) != 0) {
+		std::cerr << "Not a clique spill file: " << path << "\n";
+		return false;
+	}
+
+	std::vector<int32_t> clique;
+	int32_t count = 0;
+	while (in.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+		if (count < 0) return false;
+		clique.resize(static_cast<size_t>(count));
+		if (!in.read(reinterpret_cast<char*>(clique.data()), static_cast<std::streamsize>(count * sizeof(int32_t)))) {
+			std::cerr << "Truncated clique spill file: " << path << "\n";
+			return false;
+		}
+		sink.onClique(clique.data(), clique.size());
+	}
+	sink.finish();
+	return true;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file columnar_dataset.cpp
+ * @brief Implementation: Binary columnar dataset format
+ */
+
+#include "columnar_dataset.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+	const char kMagic[4] = { 'C', 'L', 'D', 'B' };
+
+	uint64_t alignUp(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+	// Pad the stream with zeros up to the next 8-byte boundary
+	void padTo8(std::ofstream& out) {
+		static const char zeros[8] = {};
+		uint64_t pos = static_cast<uint64_t>(out.tellp());
+		out.write(zeros, static_cast<std::streamsize>(alignUp(pos) - pos));
+	}
+
+	template <typename T>
+	void writeColumn(std::ofstream& out, const std::vector<T>& column) {
+		out.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(column.size() * sizeof(T)));
+		padTo8(out);
+	}
+
+	// Pointer to a column of numRows elements at offset, or throw if it leaves the file
+	template <typename T>
+	const T* columnAt(const MappedFile& file, uint64_t offset, uint64_t numRows) {
+		if (offset % alignof(T) != 0 || offset > file.size() || numRows > (file.size() - offset) / sizeof(T)) {
+			throw std::runtime_error("Columnar dataset is truncated or corrupt");
+		}
+		return reinterpret_cast<const T*>(file.data() + offset);
+	}
+}
+
+ColumnarDataset::ColumnarDataset(const std::string& path) : file(path) {
+	if (file.size() < sizeof(Header)) throw std::runtime_error(path + " is not a columnar dataset");
+	std::memcpy(&header, file.data(), sizeof(Header));
+	if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+		throw std::runtime_error(path + " is not a columnar dataset");
+	}
+	if (header.version != kVersion) {
+		throw std::runtime_error(path + ": unsupported columnar dataset version " + std::to_string(header.version));
+	}
+
+	// Dictionary: uint32 length + bytes per feature
+	uint64_t pos = header.dictionaryOffset;
+	names.reserve(header.numFeatures);
+	for (uint32_t f = 0; f < header.numFeatures; ++f) {
+		uint32_t len = 0;
+		if (pos + sizeof(len) > file.size()) throw std::runtime_error(path + ": corrupt feature dictionary");
+		std::memcpy(&len, file.data() + pos, sizeof(len));
+		pos += sizeof(len);
+		if (pos + len > file.size()) throw std::runtime_error(path + ": corrupt feature dictionary");
+		names.emplace_back(file.data() + pos, len);
+		pos += len;
+	}
+
+	uint64_t n = header.numRows;
+	featureColumn = columnAt<FeatureType>(file, header.featureOffset, n);
+	instanceColumn = columnAt<int32_t>(file, header.instanceOffset, n);
+	xColumn = columnAt<double>(file, header.xOffset, n);
+	yColumn = columnAt<double>(file, header.yOffset, n);
+	if (header.flags & kHasCheckin) checkinColumn = columnAt<double>(file, header.checkinOffset, n);
+}
+
+bool ColumnarDataset::isColumnarFile(const std::string& path) {
+	std::ifstream in(path, std::ios::binary);
+	char magic[4] = {};
+	return in.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+void ColumnarDataset::write(const std::string& path,
+	const std::vector<std::string>& featureNames,
+	const std::vector<FeatureType>& featureIds,
+	const std::vector<int32_t>& instanceNumbers,
+	const std::vector<double>& x,
+	const std::vector<double>& y,
+	const std::vector<double>& checkin) {
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out.is_open()) throw std::runtime_error("Cannot write " + path);
+
+	uint64_t n = featureIds.size();
+	Header h{};
+	std::memcpy(h.magic, kMagic, sizeof(kMagic));
+	h.version = kVersion;
+	h.numRows = n;
+	h.numFeatures = static_cast<uint32_t>(featureNames.size());
+	h.flags = checkin.empty() ? 0 : kHasCheckin;
+
+	// Section offsets follow from the sizes alone
+	uint64_t dictionaryBytes = 0;
+	for (const auto& name : featureNames) dictionaryBytes += sizeof(uint32_t) + name.size();
+	h.dictionaryOffset = alignUp(sizeof(Header));
+	h.featureOffset = alignUp(h.dictionaryOffset + dictionaryBytes);
+	h.instanceOffset = alignUp(h.featureOffset + n * sizeof(FeatureType));
+	h.xOffset = alignUp(h.instanceOffset + n * sizeof(int32_t));
+	h.yOffset = h.xOffset + n * sizeof(double);
+	h.checkinOffset = checkin.empty() ? 0 : h.yOffset + n * sizeof(double);
+
+	out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+	padTo8(out);
+	for (const auto& name : featureNames) {
+		uint32_t len = static_cast<uint32_t>(name.size());
+		out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+		out.write(name.data(), len);
+	}
+	padTo8(out);
+	writeColumn(out, featureIds);
+	writeColumn(out, instanceNumbers);
+	writeColumn(out, x);
+	writeColumn(out, y);
+	if (!checkin.empty()) writeColumn(out, checkin);
+
+	if (!out) throw std::runtime_error("Failed writing " + path);
+}
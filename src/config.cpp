@@ -34,14 +34,28 @@ AppConfig ConfigLoader::load(const std::string& configPath) {
         std::string key;
 
         if (std::getline(is_line, key, '=')) {
+            // "key=" with nothing after '=' reads as an empty value
             std::string value;
-            if (std::getline(is_line, value)) {
-                if (key == "dataset_path") config.datasetPath = value;
-                else if (key == "neighbor_distance") config.neighborDistance = std::stod(value);
-                else if (key == "min_prevalence") config.minPrev = std::stod(value);
-                else if (key == "min_cond_prob") config.minCondProb = std::stod(value);
-                else if (key == "debug_mode") config.debugMode = (value == "true" || value == "1");
-            }
+            if (!std::getline(is_line, value)) value.clear();
+
+            // Text settings take empty values (e.g. "output_path=" turns rule generation off)
+            if (key == "dataset_path") config.datasetPath = value;
+            else if (key == "output_path") config.outputPath = value;
+            else if (key == "neighbor_method") config.neighborMethod = value;
+            else if (key == "reorder") config.reorder = value;
+            else if (key == "clique_sink") config.cliqueSink = value;
+            else if (key == "spill_path") config.spillPath = value;
+            else if (key == "tile_dir") config.tileDir = value;
+            // Numbers and flags keep their defaults when left empty
+            else if (value.empty()) continue;
+            else if (key == "neighbor_distance") config.neighborDistance = std::stod(value);
+            else if (key == "min_prevalence") config.minPrev = std::stod(value);
+            else if (key == "min_cond_prob") config.minCondProb = std::stod(value);
+            else if (key == "top_k") config.topK = std::stoi(value);
+            else if (key == "tile_size") config.tileSize = std::stod(value);
+            else if (key == "feature_aware_enumeration") config.featureAwareEnumeration = (value == "true" || value == "1");
+            else if (key == "num_threads") config.numThreads = std::stoi(value);
+            else if (key == "debug_mode") config.debugMode = (value == "true" || value == "1");
         }
     }
 
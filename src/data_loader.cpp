@@ -1,23 +1,217 @@
 /**
  * @file data_loader.cpp
- * @brief Implementation of CSV data loading for spatial instances
+ * @brief Implementation of CSV and columnar data loading for spatial instances
  */
 
 #include "data_loader.h"
+#include "columnar_dataset.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
 
 using namespace csv;
 
+namespace {
+
+    // Bytes of CSV text per parse chunk, at least
+    constexpr size_t kMinChunkBytes = 1 << 20;
+
+    // Bytes of CSV text read per block when a file is streamed instead of mapped
+    constexpr size_t kScanBlockBytes = 1 << 20;
+
+    /** @brief Column positions of the fields load_csv reads */
+    struct CsvLayout {
+        int feature = -1;
+        int instance = -1;
+        int x = -1;
+        int y = -1;
+        int checkin = -1;  ///< Parsed only when set (scan); load_csv keeps no checkins
+        int numColumns = 0;
+    };
+
+    /** @brief Rows parsed from one byte range of the file, with chunk-local feature ids */
+    struct CsvChunk {
+        std::vector<std::string_view> names;  ///< Local feature names in order of first appearance
+        std::vector<FeatureType> features;
+        std::vector<int> instanceNumbers;
+        std::vector<double> xs, ys;
+        std::vector<double> checkins;         ///< Empty unless the layout has a checkin column
+        bool fallback = false;                ///< A row needs the full CSV reader (quotes, spaces, '+', ...)
+    };
+
+    // Strip a trailing '\r' (CRLF files)
+    std::string_view trimLine(const char* begin, const char* end) {
+        if (end > begin && end[-1] == '\r') --end;
+        return std::string_view(begin, static_cast<size_t>(end - begin));
+    }
+
+    // Split a line on commas into at most maxFields fields; returns the field count
+    int splitFields(std::string_view line, std::string_view* fields, int maxFields) {
+        int count = 0;
+        size_t start = 0;
+        while (count < maxFields) {
+            size_t comma = line.find(',', start);
+            if (comma == std::string_view::npos) {
+                fields[count++] = line.substr(start);
+                break;
+            }
+            fields[count++] = line.substr(start, comma - start);
+            start = comma + 1;
+        }
+        return count;
+    }
+
+    // Header with plain comma-separated names, same X/Y preference as scan_csv
+    bool parseLayout(std::string_view header, CsvLayout& layout) {
+        int xCol = -1, yCol = -1, locXCol = -1, locYCol = -1;
+        size_t start = 0;
+        for (int col = 0; ; ++col) {
+            size_t comma = header.find(',', start);
+            std::string_view name = header.substr(start, comma == std::string_view::npos ? std::string_view::npos : comma - start);
+            if (name == "Feature") layout.feature = col;
+            else if (name == "Instance") layout.instance = col;
+            else if (name == "X") xCol = col;
+            else if (name == "Y") yCol = col;
+            else if (name == "LocX") locXCol = col;
+            else if (name == "LocY") locYCol = col;
+            else if (name == "Checkin") layout.checkin = col;
+            layout.numColumns = col + 1;
+            if (comma == std::string_view::npos) break;
+            start = comma + 1;
+        }
+        layout.x = xCol >= 0 ? xCol : locXCol;
+        layout.y = yCol >= 0 ? yCol : locYCol;
+        return layout.feature >= 0 && layout.instance >= 0 && layout.x >= 0 && layout.y >= 0;
+    }
+
+    template <typename T>
+    bool parseNumber(std::string_view field, T& value) {
+        const char* end = field.data() + field.size();
+        auto result = std::from_chars(field.data(), end, value);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    // Parse the complete lines in [begin, end) into chunk; stops and sets chunk.fallback
+    // at the first line that is not plain unquoted comma-separated numbers and names
+    void parseChunk(const char* begin, const char* end, const CsvLayout& layout, CsvChunk& chunk) {
+        std::unordered_map<std::string_view, FeatureType> localIds;
+        std::vector<std::string_view> fields(layout.numColumns);
+        int needed = std::max(std::max(std::max(layout.feature, layout.instance), std::max(layout.x, layout.y)), layout.checkin) + 1;
+
+        size_t estimate = static_cast<size_t>(end - begin) / 24;
+        chunk.features.reserve(estimate);
+        chunk.instanceNumbers.reserve(estimate);
+        chunk.xs.reserve(estimate);
+        chunk.ys.reserve(estimate);
+        if (layout.checkin >= 0) chunk.checkins.reserve(estimate);
+
+        for (const char* p = begin; p < end; ) {
+            const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            if (!eol) eol = end;
+            std::string_view line = trimLine(p, eol);
+            p = eol + 1;
+            if (line.empty()) continue;
+
+            if (std::memchr(line.data(), '"', line.size())
+                || splitFields(line, fields.data(), layout.numColumns) < needed) {
+                chunk.fallback = true;
+                return;
+            }
+
+            int instanceNumber = 0;
+            double x = 0.0, y = 0.0, checkin = 0.0;
+            if (!parseNumber(fields[layout.instance], instanceNumber)
+                || !parseNumber(fields[layout.x], x)
+                || !parseNumber(fields[layout.y], y)
+                || (layout.checkin >= 0 && !parseNumber(fields[layout.checkin], checkin))) {
+                chunk.fallback = true;
+                return;
+            }
+
+            std::string_view name = fields[layout.feature];
+            auto it = localIds.find(name);
+            if (it == localIds.end()) {
+                if (chunk.names.size() > std::numeric_limits<FeatureType>::max()) {
+                    chunk.fallback = true;
+                    return;
+                }
+                it = localIds.emplace(name, static_cast<FeatureType>(chunk.names.size())).first;
+                chunk.names.push_back(name);
+            }
+
+            chunk.features.push_back(it->second);
+            chunk.instanceNumbers.push_back(instanceNumber);
+            chunk.xs.push_back(x);
+            chunk.ys.push_back(y);
+            if (layout.checkin >= 0) chunk.checkins.push_back(checkin);
+        }
+    }
+
+    // Parse a CSV file block by block, holding one block of about kScanBlockBytes in memory;
+    // onChunk(chunk) gets the rows of every block in file order and returns false to stop.
+    // Returns false without calling onChunk if the header is not plain comma-separated names
+    template <typename OnChunk>
+    bool parseBlocks(const std::string& filepath, CsvLayout& layout, OnChunk&& onChunk) {
+        std::ifstream in(filepath, std::ios::binary);
+        if (!in.is_open()) throw std::runtime_error("Cannot open " + filepath);
+
+        std::string header;
+        if (!std::getline(in, header)) return false;
+        std::string_view headerLine = trimLine(header.data(), header.data() + header.size());
+        if (headerLine.find('"') != std::string_view::npos || !parseLayout(headerLine, layout)) return false;
+
+        std::vector<char> block(kScanBlockBytes);
+        size_t carried = 0;  // Bytes of an unfinished line kept from the previous block
+        for (;;) {
+            // A single line longer than the block: grow it
+            if (carried == block.size()) block.resize(block.size() * 2);
+            in.read(block.data() + carried, static_cast<std::streamsize>(block.size() - carried));
+            size_t filled = carried + static_cast<size_t>(in.gcount());
+            bool atEnd = filled < block.size();
+            if (filled == 0) break;
+
+            const char* begin = block.data();
+            const char* end = begin + filled;
+            if (!atEnd) {
+                const char* lastEol = end;
+                while (lastEol > begin && lastEol[-1] != '\n') --lastEol;
+                if (lastEol == begin) {
+                    carried = filled;
+                    continue;
+                }
+                end = lastEol;
+            }
+
+            CsvChunk chunk;
+            parseChunk(begin, end, layout, chunk);
+            if (!onChunk(chunk) || atEnd) break;
+
+            carried = static_cast<size_t>(begin + filled - end);
+            std::memmove(block.data(), end, carried);
+        }
+        return true;
+    }
+}
+
 
 /**
- * @brief Load spatial instances from a CSV file
+ * @brief Stream the rows of a CSV file without storing them
  * @param filepath Path to the CSV file
- * @return std::vector<SpatialInstance> Vector of loaded spatial instances
+ * @param onRow Called as onRow(featureName, instanceNumber, x, y, checkin) for every row
+ * @return bool True if the file has a Checkin column
  *
- * Expects CSV with columns: Feature, Instance, LocX, LocY.
- * Instance IDs are generated as: FeatureType + InstanceNumber (e.g., "A1", "B2").
+ * Accepts both coordinate header variants (LocX/LocY and X/Y).
  */
-std::vector<SpatialInstance> DataLoader::load_csv(const std::string& filepath) {
+bool DataLoader::scan_csv(const std::string& filepath, const RowCallback& onRow) {
     CSVReader reader(filepath);
     auto colNames = reader.get_col_names();
     std::string xCol = "LocX";
@@ -28,19 +222,320 @@ std::vector<SpatialInstance> DataLoader::load_csv(const std::string& filepath) {
 
     if (hasColumn("X")) xCol = "X";
     if (hasColumn("Y")) yCol = "Y";
-
-    std::vector<SpatialInstance> instances;
+    bool hasCheckin = hasColumn("Checkin");
 
     for (auto& row : reader) {
+        onRow(row["Feature"].get<std::string>(),
+            row["Instance"].get<int>(),
+            row[xCol].get<double>(),
+            row[yCol].get<double>(),
+            hasCheckin ? row["Checkin"].get<double>() : 0.0);
+    }
+    return hasCheckin;
+}
+
+/**
+ * @brief Stream the rows of a CSV or columnar dataset
+ * @param filepath Path to the dataset
+ * @param onRow Called as onRow(featureName, instanceNumber, x, y, checkin) for every row
+ *
+ * Plain CSV files are read in blocks of kScanBlockBytes through the chunk parser of
+ * load_csv, so memory does not grow with the file; others go through scan_csv.
+ */
+void DataLoader::scan(const std::string& filepath, const RowCallback& onRow) {
+    if (!ColumnarDataset::isColumnarFile(filepath)) {
+        // Rows cannot be taken back once they are handed out, so a first pass checks that
+        // every block parses before the plain parser is trusted; both passes hold one block
+        CsvLayout layout;
+        bool plain = true;
+        bool plainHeader = parseBlocks(filepath, layout, [&](const CsvChunk& chunk) {
+            plain = !chunk.fallback;
+            return plain;
+            });
+        if (!plainHeader || !plain) {
+            scan_csv(filepath, onRow);
+            return;
+        }
+
+        std::vector<std::string> names;
+        parseBlocks(filepath, layout, [&](const CsvChunk& chunk) {
+            names.assign(chunk.names.begin(), chunk.names.end());
+            for (size_t i = 0; i < chunk.features.size(); ++i) {
+                onRow(names[chunk.features[i]], chunk.instanceNumbers[i], chunk.xs[i], chunk.ys[i],
+                    chunk.checkins.empty() ? 0.0 : chunk.checkins[i]);
+            }
+            return true;
+            });
+        return;
+    }
+
+    ColumnarDataset columns(filepath);
+    const auto& names = columns.featureNames();
+    const double* checkins = columns.checkins();
+    for (size_t i = 0; i < columns.size(); ++i) {
+        onRow(names[columns.featureIds()[i]],
+            columns.instanceNumbers()[i],
+            columns.xs()[i],
+            columns.ys()[i],
+            checkins ? checkins[i] : 0.0);
+    }
+}
+
+/**
+ * @brief Sort feature names and map first-seen ids to lexicographic ranks
+ * @param firstSeenNames Feature names in order of first appearance
+ * @param sortedNames Receives the names in lexicographic order
+ * @return std::vector<FeatureType> remap[firstSeenId] = final id
+ */
+std::vector<FeatureType> DataLoader::rank_feature_names(
+    const std::vector<std::string>& firstSeenNames,
+    std::vector<std::string>& sortedNames) {
+    std::vector<FeatureType> byName(firstSeenNames.size());
+    for (size_t i = 0; i < byName.size(); ++i) byName[i] = static_cast<FeatureType>(i);
+    std::sort(byName.begin(), byName.end(), [&](FeatureType a, FeatureType b) {
+        return firstSeenNames[a] < firstSeenNames[b];
+        });
+
+    std::vector<FeatureType> remap(firstSeenNames.size());
+    sortedNames.clear();
+    sortedNames.reserve(byName.size());
+    for (size_t rank = 0; rank < byName.size(); ++rank) {
+        remap[byName[rank]] = static_cast<FeatureType>(rank);
+        sortedNames.push_back(firstSeenNames[byName[rank]]);
+    }
+    return remap;
+}
+
+/**
+ * @brief Load spatial instances from a CSV file through csv.hpp
+ * @param filepath Path to the CSV file
+ * @return SpatialDataset Loaded instances and their feature/instance dictionary
+ *
+ * Expects CSV with columns: Feature, Instance, LocX, LocY.
+ * Feature names are interned while reading, then renumbered in lexicographic order.
+ */
+SpatialDataset DataLoader::load_csv_reader(const std::string& filepath) {
+    SpatialDataset dataset;
+    InstanceTable& instances = dataset.instances;
+
+    // Feature name -> provisional id (order of first appearance)
+    std::unordered_map<std::string, FeatureType> featureIds;
+    std::vector<std::string> firstSeenNames;
+
+    scan_csv(filepath, [&](const std::string& featureName, int instanceNumber, double x, double y, double) {
         SpatialInstance instance;
 
-        instance.type = row["Feature"].get<FeatureType>();
-        instance.id = instance.type + std::to_string(row["Instance"].get<int>());
-        instance.x = row[xCol].get<double>();
-        instance.y = row[yCol].get<double>();
+        auto it = featureIds.find(featureName);
+        if (it == featureIds.end()) {
+            if (firstSeenNames.size() > std::numeric_limits<FeatureType>::max()) {
+                throw std::runtime_error("Too many distinct features in " + filepath);
+            }
+            it = featureIds.emplace(featureName, static_cast<FeatureType>(firstSeenNames.size())).first;
+            firstSeenNames.push_back(featureName);
+        }
 
+        instance.type = it->second;
+        instance.id = static_cast<InstanceID>(instances.size());
+        instance.x = x;
+        instance.y = y;
+
+        dataset.dictionary.instanceNumbers.push_back(instanceNumber);
         instances.push_back(instance);
+        });
+
+    // Renumber features so that id order matches name order
+    std::vector<FeatureType> remap = rank_feature_names(firstSeenNames, dataset.dictionary.featureNames);
+    FeatureType* features = instances.feature.mutableData();
+    for (size_t i = 0; i < instances.size(); ++i) {
+        features[i] = remap[features[i]];
     }
 
-    return instances;
-}
\ No newline at end of file
+    return dataset;
+}
+
+/**
+ * @brief Load spatial instances from a CSV file, parsing byte ranges in parallel
+ * @param filepath Path to the CSV file
+ * @param numThreads Parser threads
+ * @return SpatialDataset Loaded instances and their feature/instance dictionary
+ *
+ * The file is memory-mapped and cut into ranges that start and end on line
+ * boundaries. Each range is parsed with std::from_chars into its own column buffers
+ * with chunk-local feature ids; the buffers are then stitched together in file order,
+ * so ids and instance order do not depend on the thread count.
+ * Files without a plain comma header, or with any row the chunk parser does not
+ * accept (quoted fields, padded or signed numbers, ...), go through load_csv_reader.
+ */
+SpatialDataset DataLoader::load_csv(const std::string& filepath, unsigned numThreads) {
+    MappedFile file(filepath);
+    const char* data = file.data();
+    const char* fileEnd = data + file.size();
+
+    const char* headerEnd = data ? static_cast<const char*>(std::memchr(data, '\n', file.size())) : nullptr;
+    CsvLayout layout;
+    if (!headerEnd
+        || std::memchr(data, '"', static_cast<size_t>(headerEnd - data))
+        || !parseLayout(trimLine(data, headerEnd), layout)) {
+        return load_csv_reader(filepath);
+    }
+    layout.checkin = -1;
+
+    // Chunk boundaries: even byte splits, each moved forward to the next line start
+    const char* bodyBegin = headerEnd + 1;
+    size_t bodyBytes = static_cast<size_t>(fileEnd - bodyBegin);
+    size_t numChunks = numThreads <= 1 ? 1 : std::min<size_t>(numThreads * 4, bodyBytes / kMinChunkBytes + 1);
+    std::vector<const char*> bounds(numChunks + 1, fileEnd);
+    bounds[0] = bodyBegin;
+    for (size_t c = 1; c < numChunks; ++c) {
+        const char* p = std::max(bodyBegin + bodyBytes * c / numChunks, bounds[c - 1]);
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(fileEnd - p)));
+        bounds[c] = eol ? eol + 1 : fileEnd;
+    }
+
+    std::vector<CsvChunk> chunks(numChunks);
+    parallelForChunks(numChunks, numChunks, numThreads, [&](size_t c, size_t, size_t) {
+        parseChunk(bounds[c], bounds[c + 1], layout, chunks[c]);
+        });
+    for (const CsvChunk& chunk : chunks) {
+        if (chunk.fallback) return load_csv_reader(filepath);
+    }
+
+    // Intern chunk-local names; chunks in file order keep the first-seen order
+    std::unordered_map<std::string, FeatureType> featureIds;
+    std::vector<std::string> firstSeenNames;
+    std::vector<std::vector<FeatureType>> localToGlobal(numChunks);
+    std::vector<size_t> rowOffset(numChunks + 1, 0);
+    for (size_t c = 0; c < numChunks; ++c) {
+        for (std::string_view name : chunks[c].names) {
+            auto it = featureIds.find(std::string(name));
+            if (it == featureIds.end()) {
+                if (firstSeenNames.size() > std::numeric_limits<FeatureType>::max()) {
+                    throw std::runtime_error("Too many distinct features in " + filepath);
+                }
+                it = featureIds.emplace(std::string(name), static_cast<FeatureType>(firstSeenNames.size())).first;
+                firstSeenNames.emplace_back(name);
+            }
+            localToGlobal[c].push_back(it->second);
+        }
+        rowOffset[c + 1] = rowOffset[c] + chunks[c].features.size();
+    }
+
+    SpatialDataset dataset;
+    std::vector<FeatureType> remap = rank_feature_names(firstSeenNames, dataset.dictionary.featureNames);
+    for (auto& ids : localToGlobal) {
+        for (auto& id : ids) id = remap[id];
+    }
+
+    // Stitch the chunk buffers together; every chunk fills its own row range
+    size_t n = rowOffset[numChunks];
+    InstanceTable& instances = dataset.instances;
+    instances.resize(n);
+    dataset.dictionary.instanceNumbers.resize(n);
+    double* xs = instances.x.mutableData();
+    double* ys = instances.y.mutableData();
+    FeatureType* features = instances.feature.mutableData();
+    InstanceID* ids = instances.id.mutableData();
+    parallelForChunks(numChunks, numChunks, numThreads, [&](size_t c, size_t, size_t) {
+        const CsvChunk& chunk = chunks[c];
+        size_t first = rowOffset[c];
+        std::copy(chunk.xs.begin(), chunk.xs.end(), xs + first);
+        std::copy(chunk.ys.begin(), chunk.ys.end(), ys + first);
+        std::copy(chunk.instanceNumbers.begin(), chunk.instanceNumbers.end(), dataset.dictionary.instanceNumbers.begin() + first);
+        for (size_t i = 0; i < chunk.features.size(); ++i) {
+            features[first + i] = localToGlobal[c][chunk.features[i]];
+            ids[first + i] = static_cast<InstanceID>(first + i);
+        }
+        });
+
+    return dataset;
+}
+
+/**
+ * @brief Load a memory-mapped columnar dataset
+ * @param filepath Path to the columnar file
+ * @return SpatialDataset Loaded instances and their feature/instance dictionary
+ *
+ * Feature ids are stored already in name order, so no renumbering is needed.
+ */
+SpatialDataset DataLoader::load_binary(const std::string& filepath) {
+    auto columns = std::make_shared<ColumnarDataset>(filepath);
+    size_t n = columns->size();
+    size_t numFeatures = columns->featureNames().size();
+
+    const FeatureType* featureIds = columns->featureIds();
+    for (size_t i = 0; i < n; ++i) {
+        if (featureIds[i] >= numFeatures) {
+            throw std::runtime_error(filepath + ": feature id out of range at row " + std::to_string(i));
+        }
+    }
+
+    SpatialDataset dataset;
+    dataset.dictionary.featureNames = columns->featureNames();
+    dataset.dictionary.instanceNumbers.assign(columns->instanceNumbers(), columns->instanceNumbers() + n);
+
+    // Coordinates and features are views into the mapping, which the table keeps alive;
+    // only the row ids are materialized
+    InstanceTable& instances = dataset.instances;
+    instances.x.setView(columns->xs(), n);
+    instances.y.setView(columns->ys(), n);
+    instances.feature.setView(featureIds, n);
+    instances.id.resize(n);
+    InstanceID* ids = instances.id.mutableData();
+    for (size_t i = 0; i < n; ++i) {
+        ids[i] = static_cast<InstanceID>(i);
+    }
+    instances.backing = std::move(columns);
+
+    return dataset;
+}
+
+/**
+ * @brief Load a dataset in either format
+ * @param filepath Path to the CSV or columnar file
+ * @param numThreads Threads used to parse a CSV
+ * @return SpatialDataset Loaded instances and their feature/instance dictionary
+ */
+SpatialDataset DataLoader::load(const std::string& filepath, unsigned numThreads) {
+    if (ColumnarDataset::isColumnarFile(filepath)) return load_binary(filepath);
+    return load_csv(filepath, numThreads);
+}
+
+/**
+ * @brief Convert a CSV dataset to the binary columnar format
+ * @param csvPath Source CSV file
+ * @param binaryPath Destination file (overwritten)
+ * @return size_t Number of rows written
+ *
+ * Features get the same ids as load_csv gives them (lexicographic name order).
+ */
+size_t DataLoader::convert_csv_to_binary(const std::string& csvPath, const std::string& binaryPath) {
+    std::unordered_map<std::string, FeatureType> featureIds;
+    std::vector<std::string> firstSeenNames;
+    std::vector<FeatureType> featureColumn;
+    std::vector<int32_t> instanceColumn;
+    std::vector<double> xColumn, yColumn, checkinColumn;
+
+    bool hasCheckin = scan_csv(csvPath, [&](const std::string& featureName, int instanceNumber, double x, double y, double checkin) {
+        auto it = featureIds.find(featureName);
+        if (it == featureIds.end()) {
+            if (firstSeenNames.size() > std::numeric_limits<FeatureType>::max()) {
+                throw std::runtime_error("Too many distinct features in " + csvPath);
+            }
+            it = featureIds.emplace(featureName, static_cast<FeatureType>(firstSeenNames.size())).first;
+            firstSeenNames.push_back(featureName);
+        }
+        featureColumn.push_back(it->second);
+        instanceColumn.push_back(instanceNumber);
+        xColumn.push_back(x);
+        yColumn.push_back(y);
+        checkinColumn.push_back(checkin);
+        });
+    if (!hasCheckin) checkinColumn.clear();
+
+    std::vector<std::string> sortedNames;
+    std::vector<FeatureType> remap = rank_feature_names(firstSeenNames, sortedNames);
+    for (auto& f : featureColumn) f = remap[f];
+
+    ColumnarDataset::write(binaryPath, sortedNames, featureColumn, instanceColumn, xColumn, yColumn, checkinColumn);
+    return featureColumn.size();
+}
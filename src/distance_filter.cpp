@@ -0,0 +1,166 @@
+/**
+ * @file distance_filter.cpp
+ * @brief Implementation: Batched distance filter with runtime dispatch
+ */
+
+#include "distance_filter.h"
+#include "bit_ops.h"
+#include "set_ops.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DISTFILTER_X86 1
+#include <immintrin.h>
+#endif
+
+// Same scheme as set_ops.cpp: the AVX2 kernel is compiled for its ISA only.
+// "avx2" alone does not enable FMA, so dx * dx + dy * dy is rounded like the scalar code.
+#if defined(DISTFILTER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define DISTFILTER_KERNEL(isa) __attribute__((target(isa), flatten))
+#else
+#define DISTFILTER_KERNEL(isa)
+#endif
+
+namespace distfilter {
+
+	namespace {
+
+		// Squared distances within this relative margin of d^2 get the exact scalar check
+		constexpr double kBorderline = 1e-9;
+
+		// --- Scalar kernel ---
+		size_t runScalar(const Points& p, size_t i, size_t begin, size_t end, double d, int32_t* out) {
+			size_t n = 0;
+			for (size_t j = begin; j < end; ++j) {
+				if (p.feature[j] != p.feature[i] && withinDistance(p.x[i], p.y[i], p.x[j], p.y[j], d)) {
+					out[n++] = static_cast<int32_t>(j);
+				}
+			}
+			return n;
+		}
+
+#ifdef DISTFILTER_X86
+		/** @brief pshufb controls packing the selected 32-bit lanes of a 4-lane mask to the front */
+		struct CompressTable {
+			alignas(16) uint8_t control[16][16];
+
+			CompressTable() {
+				for (unsigned mask = 0; mask < 16; ++mask) {
+					unsigned out = 0;
+					for (unsigned lane = 0; lane < 4; ++lane) {
+						if (!((mask >> lane) & 1u)) continue;
+						for (unsigned b = 0; b < 4; ++b) control[mask][out * 4 + b] = static_cast<uint8_t>(lane * 4 + b);
+						++out;
+					}
+					for (; out < 4; ++out) {
+						for (unsigned b = 0; b < 4; ++b) control[mask][out * 4 + b] = 0x80;
+					}
+				}
+			}
+		};
+
+		const CompressTable compressTable;
+
+		// --- AVX2 kernel: 4 candidates per step ---
+		DISTFILTER_KERNEL("avx2")
+		size_t runAvx2(const Points& p, size_t i, size_t begin, size_t end, double d, int32_t* out) {
+			const __m256d signMask = _mm256_set1_pd(-0.0);
+			const __m256d vxi = _mm256_set1_pd(p.x[i]);
+			const __m256d vyi = _mm256_set1_pd(p.y[i]);
+			const __m256d vd = _mm256_set1_pd(d);
+			const __m256d vSure = _mm256_set1_pd(d * d * (1.0 - kBorderline));
+			const __m256d vMaybe = _mm256_set1_pd(d * d * (1.0 + kBorderline));
+			const __m256i vfi = _mm256_set1_epi64x(p.feature[i]);
+
+			size_t n = 0;
+			size_t j = begin;
+			for (; j + 4 <= end; j += 4) {
+				__m256d dx = _mm256_sub_pd(_mm256_loadu_pd(p.x + j), vxi);
+				__m256d dy = _mm256_sub_pd(_mm256_loadu_pd(p.y + j), vyi);
+				__m256d inBox = _mm256_and_pd(
+					_mm256_cmp_pd(_mm256_andnot_pd(signMask, dx), vd, _CMP_LE_OQ),
+					_mm256_cmp_pd(_mm256_andnot_pd(signMask, dy), vd, _CMP_LE_OQ));
+				__m256d sq = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+
+				// Feature mismatch: widen the 4 feature ids to 64-bit lanes
+				__m128i f4 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p.feature + j));
+				__m256i sameFeature = _mm256_cmpeq_epi64(_mm256_cvtepu16_epi64(f4), vfi);
+				__m256d candidate = _mm256_andnot_pd(_mm256_castsi256_pd(sameFeature), inBox);
+
+				unsigned keep = static_cast<unsigned>(_mm256_movemask_pd(
+					_mm256_and_pd(candidate, _mm256_cmp_pd(sq, vMaybe, _CMP_LE_OQ))));
+				if (!keep) continue;
+				unsigned sure = static_cast<unsigned>(_mm256_movemask_pd(
+					_mm256_and_pd(candidate, _mm256_cmp_pd(sq, vSure, _CMP_LE_OQ))));
+
+				// Borderline lanes: decide with the exact formula
+				for (unsigned border = keep & ~sure; border; border &= border - 1) {
+					unsigned lane = static_cast<unsigned>(bits::lowestBit(border));
+					if (!withinDistance(p.x[i], p.y[i], p.x[j + lane], p.y[j + lane], d)) keep &= ~(1u << lane);
+				}
+
+				// Compress-store the surviving positions
+				__m128i positions = _mm_add_epi32(_mm_set1_epi32(static_cast<int32_t>(j)), _mm_setr_epi32(0, 1, 2, 3));
+				__m128i control = _mm_load_si128(reinterpret_cast<const __m128i*>(compressTable.control[keep]));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + n), _mm_shuffle_epi8(positions, control));
+				n += bits::popcount(keep);
+			}
+			return n + runScalar(p, i, j, end, d, out + n);
+		}
+#endif
+
+		using KernelFn = size_t(*)(const Points&, size_t, size_t, size_t, double, int32_t*);
+
+		/** @brief Selected kernel and its entry point */
+		struct Dispatch {
+			Kernel kernel;
+			KernelFn run;
+		};
+
+		Dispatch makeDispatch(Kernel kernel) {
+#ifdef DISTFILTER_X86
+			if (kernel == Kernel::AVX2) return { kernel, runAvx2 };
+#endif
+			return { Kernel::Scalar, runScalar };
+		}
+
+		Dispatch& dispatch() {
+			static Dispatch d = makeDispatch(detectKernel());
+			return d;
+		}
+	}
+
+	// The AVX2 check is shared with the set kernels
+	Kernel detectKernel() {
+#ifdef DISTFILTER_X86
+		if (setops::detectKernel() == setops::Kernel::AVX2) return Kernel::AVX2;
+#endif
+		return Kernel::Scalar;
+	}
+
+	Kernel activeKernel() {
+		return dispatch().kernel;
+	}
+
+	bool setKernel(Kernel kernel) {
+		if (kernel == Kernel::AVX2 && detectKernel() != Kernel::AVX2) return false;
+		dispatch() = makeDispatch(kernel);
+		return true;
+	}
+
+	const char* kernelName(Kernel kernel) {
+		return kernel == Kernel::AVX2 ? "avx2" : "scalar";
+	}
+
+	bool withinDistance(double ax, double ay, double bx, double by, double d) {
+		return std::abs(ay - by) <= d &&
+			std::abs(ax - bx) <= d &&
+			std::sqrt(std::pow(ax - bx, 2) + std::pow(ay - by, 2)) <= d;
+	}
+
+	size_t filter(const Points& points, size_t i, size_t begin, size_t end, double d, int32_t* out) {
+		if (begin >= end) return 0;
+		return dispatch().run(points, i, begin, end, d, out);
+	}
+
+} // namespace distfilter
@@ -0,0 +1,254 @@
+/**
+ * @file instance_bitmap.cpp
+ * @brief Implementation: Roaring-style compressed instance bitmap
+ */
+
+#include "instance_bitmap.h"
+#include <algorithm>
+#include <iterator>
+
+// Container for a key, inserted in key order if missing
+InstanceBitmap::Container& InstanceBitmap::containerFor(uint16_t key) {
+	auto it = std::lower_bound(containers.begin(), containers.end(), key,
+		[](const Container& c, uint16_t k) { return c.key < k; });
+	if (it == containers.end() || it->key != key) {
+		Container c;
+		c.key = key;
+		it = containers.insert(it, std::move(c));
+	}
+	return *it;
+}
+
+// Convert an array or run container into a bitmap container
+void InstanceBitmap::toBitmap(Container& c) {
+	if (c.kind == Container::Bitmap) return;
+
+	std::vector<uint64_t> words(kBitmapWords, 0);
+	if (c.kind == Container::Array) {
+		for (uint16_t v : c.values) words[v >> 6] |= uint64_t(1) << (v & 63);
+	}
+	else {
+		for (size_t r = 0; r < c.values.size(); r += 2) {
+			uint32_t last = uint32_t(c.values[r]) + c.values[r + 1];
+			for (uint32_t v = c.values[r]; v <= last; ++v) words[v >> 6] |= uint64_t(1) << (v & 63);
+		}
+	}
+	c.words = std::move(words);
+	std::vector<uint16_t>().swap(c.values);
+	c.kind = Container::Bitmap;
+}
+
+// Insert one id
+void InstanceBitmap::add(uint32_t id) {
+	Container& c = containerFor(static_cast<uint16_t>(id >> 16));
+	uint16_t low = static_cast<uint16_t>(id & 0xFFFF);
+
+	if (c.kind == Container::Run) toBitmap(c);
+
+	if (c.kind == Container::Bitmap) {
+		uint64_t& word = c.words[low >> 6];
+		uint64_t mask = uint64_t(1) << (low & 63);
+		if (!(word & mask)) { word |= mask; ++c.card; }
+		return;
+	}
+
+	auto it = std::lower_bound(c.values.begin(), c.values.end(), low);
+	if (it != c.values.end() && *it == low) return;
+	c.values.insert(it, low);
+	++c.card;
+	if (c.card > kArrayMax) toBitmap(c);
+}
+
+// Membership test
+bool InstanceBitmap::contains(uint32_t id) const {
+	uint16_t key = static_cast<uint16_t>(id >> 16);
+	uint16_t low = static_cast<uint16_t>(id & 0xFFFF);
+	auto it = std::lower_bound(containers.begin(), containers.end(), key,
+		[](const Container& c, uint16_t k) { return c.key < k; });
+	if (it == containers.end() || it->key != key) return false;
+
+	if (it->kind == Container::Bitmap) return (it->words[low >> 6] >> (low & 63)) & 1;
+	if (it->kind == Container::Array) return std::binary_search(it->values.begin(), it->values.end(), low);
+
+	for (size_t r = 0; r < it->values.size(); r += 2) {
+		if (low < it->values[r]) return false;
+		if (low <= uint32_t(it->values[r]) + it->values[r + 1]) return true;
+	}
+	return false;
+}
+
+// Number of ids in the set (cached per container)
+size_t InstanceBitmap::cardinality() const {
+	size_t total = 0;
+	for (const auto& c : containers) total += c.card;
+	return total;
+}
+
+// dst = dst | src for two containers with the same key
+void InstanceBitmap::unionContainer(Container& dst, const Container& src) {
+	// Results that may grow large go through a bitmap. Repeated unions into one
+	// accumulator (queryInstances) then cost O(|src|) each instead of re-merging
+	// the whole accumulated array every time.
+	bool needBitmap = dst.kind == Container::Bitmap || src.kind == Container::Bitmap ||
+		uint64_t(dst.card) + src.card > kAccumulateMax;
+
+	if (needBitmap) {
+		toBitmap(dst);
+		uint64_t* d = dst.words.data();
+		if (src.kind == Container::Bitmap) {
+			// Word-parallel OR, then popcount
+			const uint64_t* s = src.words.data();
+			for (size_t w = 0; w < kBitmapWords; ++w) d[w] |= s[w];
+
+			uint32_t card = 0;
+			for (size_t w = 0; w < kBitmapWords; ++w) card += static_cast<uint32_t>(bits::popcount(d[w]));
+			dst.card = card;
+			return;
+		}
+
+		// Sparse source: set bits one by one and count the new ones
+		auto setBit = [&](uint32_t v) {
+			uint64_t mask = uint64_t(1) << (v & 63);
+			dst.card += (d[v >> 6] & mask) ? 0 : 1;
+			d[v >> 6] |= mask;
+			};
+		if (src.kind == Container::Array) {
+			for (uint16_t v : src.values) setBit(v);
+		}
+		else {
+			for (size_t r = 0; r < src.values.size(); r += 2) {
+				uint32_t last = uint32_t(src.values[r]) + src.values[r + 1];
+				for (uint32_t v = src.values[r]; v <= last; ++v) setBit(v);
+			}
+		}
+		return;
+	}
+
+	// Small results: merge the sorted value lists (runs are expanded first)
+	auto expand = [](const Container& c) {
+		if (c.kind == Container::Array) return c.values;
+		std::vector<uint16_t> out;
+		out.reserve(c.card);
+		for (size_t r = 0; r < c.values.size(); r += 2) {
+			uint32_t last = uint32_t(c.values[r]) + c.values[r + 1];
+			for (uint32_t v = c.values[r]; v <= last; ++v) out.push_back(static_cast<uint16_t>(v));
+		}
+		return out;
+		};
+
+	std::vector<uint16_t> a = expand(dst);
+	std::vector<uint16_t> b = (src.kind == Container::Array) ? std::vector<uint16_t>() : expand(src);
+	const std::vector<uint16_t>& bRef = (src.kind == Container::Array) ? src.values : b;
+
+	std::vector<uint16_t> merged;
+	merged.reserve(a.size() + bRef.size());
+	std::set_union(a.begin(), a.end(), bRef.begin(), bRef.end(), std::back_inserter(merged));
+
+	dst.values = std::move(merged);
+	dst.kind = Container::Array;
+	dst.card = static_cast<uint32_t>(dst.values.size());
+}
+
+// In-place union: merge container lists by key
+void InstanceBitmap::unionWith(const InstanceBitmap& other) {
+	if (other.containers.empty()) return;
+	if (containers.empty()) {
+		containers = other.containers;
+		return;
+	}
+
+	std::vector<Container> result;
+	result.reserve(containers.size() + other.containers.size());
+
+	size_t i = 0, j = 0;
+	while (i < containers.size() || j < other.containers.size()) {
+		if (j == other.containers.size() || (i < containers.size() && containers[i].key < other.containers[j].key)) {
+			result.push_back(std::move(containers[i++]));
+		}
+		else if (i == containers.size() || other.containers[j].key < containers[i].key) {
+			result.push_back(other.containers[j++]);
+		}
+		else {
+			unionContainer(containers[i], other.containers[j]);
+			result.push_back(std::move(containers[i]));
+			++i; ++j;
+		}
+	}
+	containers = std::move(result);
+}
+
+// Re-encode every container in its smallest form
+void InstanceBitmap::runOptimize() {
+	for (auto& c : containers) {
+		// Collect runs of consecutive values
+		std::vector<uint16_t> runs;
+		uint32_t runStart = 0, prev = 0;
+		bool open = false;
+		auto visit = [&](uint32_t v) {
+			if (open && v == prev + 1) { prev = v; return; }
+			if (open) { runs.push_back(static_cast<uint16_t>(runStart)); runs.push_back(static_cast<uint16_t>(prev - runStart)); }
+			runStart = prev = v;
+			open = true;
+			};
+
+		if (c.kind == Container::Run) continue;
+		if (c.kind == Container::Array) {
+			for (uint16_t v : c.values) visit(v);
+		}
+		else {
+			for (size_t w = 0; w < kBitmapWords; ++w) {
+				uint64_t word = c.words[w];
+				while (word) {
+					visit(uint32_t(w * 64 + bits::lowestBit(word)));
+					word &= word - 1;
+				}
+			}
+		}
+		if (open) { runs.push_back(static_cast<uint16_t>(runStart)); runs.push_back(static_cast<uint16_t>(prev - runStart)); }
+
+		// Sizes in bytes of each encoding
+		size_t runBytes = runs.size() * sizeof(uint16_t);
+		size_t arrayBytes = size_t(c.card) * sizeof(uint16_t);
+		size_t bitmapBytes = kBitmapWords * sizeof(uint64_t);
+
+		if (runBytes < arrayBytes && runBytes < bitmapBytes) {
+			c.values = std::move(runs);
+			std::vector<uint64_t>().swap(c.words);
+			c.kind = Container::Run;
+		}
+		else if (c.kind == Container::Bitmap && c.card <= kArrayMax) {
+			std::vector<uint16_t> values;
+			values.reserve(c.card);
+			for (size_t w = 0; w < kBitmapWords; ++w) {
+				uint64_t word = c.words[w];
+				while (word) {
+					values.push_back(static_cast<uint16_t>(w * 64 + bits::lowestBit(word)));
+					word &= word - 1;
+				}
+			}
+			c.values = std::move(values);
+			std::vector<uint64_t>().swap(c.words);
+			c.kind = Container::Array;
+		}
+		else {
+			c.values.shrink_to_fit();
+		}
+	}
+}
+
+// Approximate heap footprint in bytes
+size_t InstanceBitmap::memoryBytes() const {
+	size_t bytes = containers.capacity() * sizeof(Container);
+	for (const auto& c : containers) {
+		bytes += c.values.capacity() * sizeof(uint16_t) + c.words.capacity() * sizeof(uint64_t);
+	}
+	return bytes;
+}
+
+// All ids in ascending order
+std::vector<uint32_t> InstanceBitmap::toVector() const {
+	std::vector<uint32_t> out;
+	out.reserve(cardinality());
+	forEach([&](uint32_t id) { out.push_back(id); });
+	return out;
+}
@@ -6,15 +6,20 @@
 #include "config.h"
 #include "data_loader.h"
 #include "neighbor_graph.h"
+#include "spatial_order.h"
 #include "maximal_clique_hashmap.h"
+#include "tiled_executor.h"
 #include "miner.h"
+#include "rule_generator.h"
 #include "types.h"
 #include "utils.h"
+#include "parallel.h"
 #include <iostream>
 #include <chrono>
 #include <iomanip>
 #include <cmath>
 #include <fstream>
+#include <filesystem>
 
 //Show memmory usage
 #include <windows.h>
@@ -23,41 +28,189 @@
 #pragma comment(lib, "psapi.lib")
 
 int main(int argc, char* argv[]) {
+    // Conversion mode: main --convert <input.csv> <output.bin>
+    if (argc > 1 && std::string(argv[1]) == "--convert") {
+        if (argc < 4) {
+            std::cerr << "Usage: main --convert <input.csv> <output.bin>\n";
+            return 1;
+        }
+        size_t rows = DataLoader::convert_csv_to_binary(argv[2], argv[3]);
+        std::cout << "Converted " << rows << " rows to " << argv[3] << "\n";
+        return 0;
+    }
+
     auto programStart = std::chrono::high_resolution_clock::now();
     // --- Step 1: Config & Load Data ---
     std::cout << "Running... (Results will be saved to result.txt)\n";
     std::string config_path = (argc > 1) ? argv[1] : "./config/config.txt";
     AppConfig config = ConfigLoader::load(config_path);
 
-    auto instances = DataLoader::load_csv(config.datasetPath);
+    unsigned numThreads = resolveThreadCount(config.numThreads);
+    bool tiledMode = config.tileSize > 0;
+
+    // Tiled mode never holds the instances: it produces the clique hashmap directly
+    SpatialDataset dataset;
+    TiledResult tiled;
+    if (tiledMode) {
+        TiledExecutor executor(config.tileSize, config.neighborDistance, numThreads, config.tileDir);
+        tiled = executor.run(config.datasetPath, parseNeighborSearchMethod(config.neighborMethod));
+        dataset.dictionary.featureNames = std::move(tiled.featureNames);
+    }
+    else {
+        dataset = DataLoader::load(config.datasetPath, numThreads);
+
+        // Neighbors get nearby ids: better locality in the graph and denser bitmaps
+        ReorderMethod reorder = parseReorderMethod(config.reorder);
+        if (reorder != ReorderMethod::None) {
+            applyOrder(dataset, spatialOrder(dataset.instances, reorder));
+        }
+    }
+    const auto& instances = dataset.instances;
+    size_t numInstances = tiledMode ? tiled.numInstances : instances.size();
+
+    if (dataset.dictionary.featureNames.size() > Colocation::kCapacity) {
+        std::cerr << "Dataset has " << dataset.dictionary.featureNames.size()
+            << " features; rebuild with COLOCATION_MAX_FEATURES >= that count.\n";
+        return 1;
+    }
 
     // --- Step 2: Pre-processing (Indexing & Structures) ---
     // 1. Feature Counting & Sorting
-    auto featureCount = countFeatures(instances);
+    auto featureCount = tiledMode ? tiled.featureCounts : countFeatures(instances);
 
 	// 2. Delta Calculation
 	double delta = calculateDispersion(featureCount);
 
-	// 3. Neighbor Graph Building
-    NeighborGraph neighborGraph;
-    auto graph = neighborGraph.buildNeighborGraph(instances, config.neighborDistance);
+    MaximalCliqueHashmap mcHashmap(numThreads, config.featureAwareEnumeration);
+    bool generateRules = !config.outputPath.empty();
+    Miner miner(numThreads, generateRules);
+    CliqueHashMap ownedHashMap;
+    const CliqueHashMap* cliqueMap = &ownedHashMap;
+
+    if (tiledMode) {
+        // 3-4. Neighbor graph and clique hashmap, built tile by tile
+        cliqueMap = &tiled.hashMap;
+        if (config.debugMode) {
+            std::cout << "[Debug] Tiles: " << tiled.numTiles << " (side " << config.tileSize
+                << "), largest tile: " << tiled.maxTileInstances << " instances\n";
+            // Peak so far covers scanning, bucketing, every tile and the merge, not mining
+            PROCESS_MEMORY_COUNTERS tiledCounter;
+            if (GetProcessMemoryInfo(GetCurrentProcess(), &tiledCounter, sizeof(tiledCounter))) {
+                std::cout << "[Debug] Peak memory after tiling: " << tiledCounter.PeakWorkingSetSize / 1024 / 1024 << " MB\n";
+            }
+        }
+    }
+    else {
+        // 3. Neighbor Graph Building
+        auto neighborStart = std::chrono::high_resolution_clock::now();
+
+        NeighborGraph neighborGraph(numThreads);
+        auto graph = neighborGraph.buildNeighborGraph(
+            instances,
+            config.neighborDistance,
+            parseNeighborSearchMethod(config.neighborMethod));
+
+        if (config.debugMode) {
+            double neighborTime = std::chrono::duration<double>(
+                std::chrono::high_resolution_clock::now() - neighborStart).count();
+            std::cout << "[Debug] Neighbor graph (" << config.neighborMethod << ", " << numThreads
+                << " threads): " << std::fixed << std::setprecision(3) << neighborTime << " s\n";
+        }
+
+        // 4. Build Instance Hashmap from Maximal Cliques (through the configured sink)
+        if (config.cliqueSink == "count") {
+            // Enumeration only: no aggregation, no mining. Only the enumerate call is timed.
+            CountingSink counter;
+            auto enumStart = std::chrono::high_resolution_clock::now();
+            mcHashmap.enumerate(graph, counter);
+            double enumTime = std::chrono::duration<double>(
+                std::chrono::high_resolution_clock::now() - enumStart).count();
+            std::cout << "[Enumeration] Cliques: " << counter.cliques
+                << ", vertices: " << counter.vertices
+                << ", largest: " << counter.maxSize
+                << ", time: " << std::fixed << std::setprecision(3) << enumTime << " s\n";
+            return 0;
+        }
+        else if (config.cliqueSink == "spill") {
+            // Enumerate to disk, then aggregate by replaying the spill file
+            {
+                SpillSink spill(config.spillPath);
+                if (!spill.isOpen()) return 1;
+                mcHashmap.enumerate(graph, spill);
+                if (config.debugMode) {
+                    std::cout << "[Debug] Spilled " << spill.bytesWritten() << " bytes to " << config.spillPath << "\n";
+                }
+            }
+            // Replay only reads features and ids: free the graph and the coordinates
+            // first so they are never held together with the hashmap
+            graph = CSRGraph();
+            dataset.instances.releaseCoordinates();
+            HashmapSink replay(instances, ownedHashMap);
+            if (!replaySpill(config.spillPath, replay)) return 1;
+        }
+        else {
+            ownedHashMap = mcHashmap.executeBK(graph);
+        }
+    }
+    const CliqueHashMap& hashMap = *cliqueMap;
+
+    if (config.debugMode && !tiledMode) {
+        const auto& degeneracyInfo = mcHashmap.getDegeneracyInfo();
+        double coreSum = 0.0;
+        for (int core : degeneracyInfo.coreNumbers) coreSum += core;
+        double meanCore = degeneracyInfo.coreNumbers.empty() ? 0.0 : coreSum / degeneracyInfo.coreNumbers.size();
+        std::cout << "[Debug] Degeneracy: " << degeneracyInfo.degeneracy
+            << ", mean core number: " << std::fixed << std::setprecision(2) << meanCore << "\n";
 
-	// 4. Build Instance Hashmap from Maximal Cliques
-	MaximalCliqueHashmap mcHashmap;
-    auto hashMap = mcHashmap.executeBK(graph);
+        const auto& enumerationStats = mcHashmap.getEnumerationStats();
+        std::cout << "[Debug] BK recursion nodes: " << enumerationStats.recursionNodes
+            << ", working-storage heap allocations: " << enumerationStats.heapAllocations << "\n";
+        std::cout << "[Debug] Cliques reported: " << enumerationStats.reportedCliques
+            << " (" << enumerationStats.featureShortcuts << " feature-aware shortcuts), distinct keys: "
+            << hashMap.size() << "\n";
+    }
 
 	// 5. Get Candidate Colocations
 	auto candidateQueue = mcHashmap.extractInitialCandidates(hashMap);
 
     // --- Step 3: Mining Prevalent Co-location Patterns ---
-    Miner miner;
-    auto colocations = miner.minePCPs(
-        candidateQueue,
-        hashMap,
-        featureCount,
-        delta,
-        config.minPrev
-    );
+    // Top-K mode keeps the K best patterns with their weighted PI
+    bool topKMode = config.topK > 0;
+    std::set<Colocation> colocations;
+    std::vector<ScoredColocation> topPatterns;
+    if (topKMode) {
+        topPatterns = miner.mineTopK(
+            candidateQueue,
+            hashMap,
+            featureCount,
+            delta,
+            config.minPrev,
+            static_cast<size_t>(config.topK)
+        );
+    }
+    else {
+        colocations = miner.minePCPs(
+            candidateQueue,
+            hashMap,
+            featureCount,
+            delta,
+            config.minPrev
+        );
+    }
+
+    // --- Step 4: Rule Generation (from the participation ratios kept by the miner) ---
+    std::vector<ColocationRule> rules;
+    if (generateRules) {
+        std::vector<Colocation> patterns;
+        if (topKMode) {
+            for (const auto& scored : topPatterns) patterns.push_back(scored.pattern);
+        }
+        else {
+            patterns.assign(colocations.begin(), colocations.end());
+        }
+        RuleGenerator ruleGenerator(numThreads);
+        rules = ruleGenerator.generate(patterns, miner.patternParticipation(), config.minCondProb);
+    }
 
     // --- END OF PROCESSING ---
     auto programEnd = std::chrono::high_resolution_clock::now();
@@ -82,9 +235,10 @@ int main(int argc, char* argv[]) {
     // (A) Thông tin Dataset & Config
     outFile << "=== FINAL REPORT ===\n";
     outFile << "Dataset Path:      " << config.datasetPath << "\n";
-    outFile << "Total Instances:   " << instances.size() << "\n";
+    outFile << "Total Instances:   " << numInstances << "\n";
     outFile << "Neighbor Distance: " << config.neighborDistance << "\n";
     outFile << "Min Prevalence:    " << config.minPrev << "\n";
+    if (topKMode) outFile << "Top K:             " << config.topK << "\n";
     outFile << "----------------------------------------\n";
 
 	// (B) Execution Time
@@ -94,18 +248,34 @@ int main(int argc, char* argv[]) {
     outFile << "Peak Memory Usage: " << peakMemMB << " MB\n";
 
 	// (D) Number of Patterns Found
-    outFile << "Patterns Found: " << colocations.size() << "\n";
+    outFile << "Patterns Found: " << (topKMode ? topPatterns.size() : colocations.size()) << "\n";
     outFile << "----------------------------------------\n";
 
 	// (E) List of Patterns
-    if (!colocations.empty()) {
+    auto writePattern = [&](const Colocation& col) {
+        outFile << "{";
+        bool first = true;
+        for (FeatureType f : col) {
+            outFile << (first ? "" : ", ") << dataset.dictionary.featureName(f);
+            first = false;
+        }
+        outFile << "}";
+    };
+    if (topKMode && !topPatterns.empty()) {
+        // Best first, with the weighted PI
+        int idx = 1;
+        for (const auto& scored : topPatterns) {
+            outFile << "[" << idx++ << "] ";
+            writePattern(scored.pattern);
+            outFile << " PI=" << std::setprecision(4) << scored.weightedPI << "\n";
+        }
+    }
+    else if (!colocations.empty()) {
         int idx = 1;
         for (const auto& col : colocations) {
-            outFile << "[" << idx++ << "] {";
-            for (size_t i = 0; i < col.size(); ++i) {
-                outFile << (i > 0 ? ", " : "") << col[i];
-            }
-            outFile << "}\n";
+            outFile << "[" << idx++ << "] ";
+            writePattern(col);
+            outFile << "\n";
         }
     }
     else {
@@ -114,6 +284,43 @@ int main(int argc, char* argv[]) {
 
     outFile.close();
 
+    // 3. Write Rules
+    if (generateRules) {
+        std::filesystem::path rulesPath(config.outputPath);
+        std::error_code ec;
+        if (rulesPath.has_parent_path()) std::filesystem::create_directories(rulesPath.parent_path(), ec);
+
+        std::ofstream rulesFile(rulesPath);
+        if (!rulesFile.is_open()) {
+            std::cerr << "Cannot open " << config.outputPath << " for writing.\n";
+            return 1;
+        }
+        auto writeFeatures = [&](const Colocation& col) {
+            rulesFile << "{";
+            bool first = true;
+            for (FeatureType f : col) {
+                rulesFile << (first ? "" : ", ") << dataset.dictionary.featureName(f);
+                first = false;
+            }
+            rulesFile << "}";
+        };
+        rulesFile << "=== COLOCATION RULES ===\n";
+        rulesFile << "Min Conditional Probability: " << config.minCondProb << "\n";
+        rulesFile << "Rules Found: " << rules.size() << "\n";
+        rulesFile << "----------------------------------------\n";
+        int idx = 1;
+        for (const auto& rule : rules) {
+            rulesFile << "[" << idx++ << "] ";
+            writeFeatures(rule.antecedent);
+            rulesFile << " -> ";
+            writeFeatures(rule.consequent);
+            rulesFile << " cp=" << std::fixed << std::setprecision(4) << rule.conditionalProbability << "\n";
+        }
+        if (config.debugMode) {
+            std::cout << "[Debug] Rules: " << rules.size() << " written to " << config.outputPath << "\n";
+        }
+    }
+
     std::cout << "Done! Please check 'result.txt'.\n";
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+/**
+ * @file mapped_file.cpp
+ * @brief Implementation: Read-only memory-mapped file
+ */
+
+#include "mapped_file.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open " + path);
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		throw std::runtime_error("Cannot stat " + path);
+	}
+	fileHandle = file;
+	length = static_cast<size_t>(fileSize.QuadPart);
+	if (length == 0) return;
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		unmap();
+		throw std::runtime_error("Cannot map " + path);
+	}
+	mappingHandle = mapping;
+
+	base = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!base) {
+		unmap();
+		throw std::runtime_error("Cannot map " + path);
+	}
+}
+
+void MappedFile::unmap() {
+	if (base) UnmapViewOfFile(base);
+	if (mappingHandle) CloseHandle(mappingHandle);
+	if (fileHandle) CloseHandle(fileHandle);
+	base = nullptr;
+	length = 0;
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) throw std::runtime_error("Cannot open " + path);
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0) {
+		::close(fd);
+		throw std::runtime_error("Cannot stat " + path);
+	}
+	length = static_cast<size_t>(st.st_size);
+	if (length > 0) {
+		void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED) {
+			::close(fd);
+			length = 0;
+			throw std::runtime_error("Cannot map " + path);
+		}
+		base = static_cast<const char*>(p);
+	}
+	// The mapping keeps the file alive
+	::close(fd);
+}
+
+void MappedFile::unmap() {
+	if (base) ::munmap(const_cast<char*>(base), length);
+	base = nullptr;
+	length = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		unmap();
+		std::swap(base, other.base);
+		std::swap(length, other.length);
+#ifdef _WIN32
+		std::swap(fileHandle, other.fileHandle);
+		std::swap(mappingHandle, other.mappingHandle);
+#endif
+	}
+	return *this;
+}
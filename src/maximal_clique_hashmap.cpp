@@ -5,6 +5,9 @@
  */
 
 #include "maximal_clique_hashmap.h"
+#include "work_stealing_pool.h"
+#include "bit_ops.h"
+#include "set_ops.h"
 #include <algorithm>
 #include <iostream>
 #include <iterator>
@@ -12,150 +15,638 @@
 #include <map>
 #include <set>
 #include <unordered_map>
+#include <array>
 #include <cmath> // For floor/ceil if needed
+#include <memory>
 
 namespace {
 
-    using Node = const SpatialInstance*;
+    using Node = int32_t;
     using CliqueVec = std::vector<Node>;
-    using AdjMap = std::unordered_map<Node, CliqueVec>;
 
-    // Type definition for the result map structure
-    using ResultMap = std::map<Colocation, std::unordered_map<FeatureType, std::set<const SpatialInstance*>>>;
+    // Sorted neighbor row of a vertex, viewed directly in the CSR arrays
+    struct NeighborRow {
+        const Node* first;
+        const Node* last;
+        const Node* begin() const { return first; }
+        const Node* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+    };
+
+    NeighborRow neighborsOf(const CSRGraph& graph, Node u) {
+        return { graph.rowBegin(u), graph.rowEnd(u) };
+    }
+
+    // --- PER-THREAD ARENA ---
+    // Bump allocator for the P/X/candidate sets of the recursion. Every frame takes a
+    // mark on entry and releases it on exit (LIFO), so once the chunks have grown to
+    // the deepest branch seen, enumeration runs without touching the heap.
+    class NodeArena {
+    public:
+        struct Mark {
+            size_t chunk;
+            size_t used;
+        };
+
+        Mark mark() const {
+            return { current, chunks.empty() ? 0 : chunks[current].used };
+        }
+
+        void release(Mark m) {
+            current = m.chunk;
+            if (current < chunks.size()) chunks[current].used = m.used;
+        }
+
+        // Storage for n nodes; newChunks counts the heap allocations this caused
+        Node* allocate(size_t n, size_t& newChunks) {
+            while (current < chunks.size()) {
+                Chunk& c = chunks[current];
+                if (c.capacity - c.used >= n) {
+                    Node* p = c.data.get() + c.used;
+                    c.used += n;
+                    return p;
+                }
+                if (current + 1 == chunks.size()) break;
+                chunks[++current].used = 0;
+            }
+            size_t capacity = std::max(kChunkNodes, n);
+            chunks.push_back({ std::unique_ptr<Node[]>(new Node[capacity]), capacity, n });
+            current = chunks.size() - 1;
+            ++newChunks;
+            return chunks[current].data.get();
+        }
+
+    private:
+        static constexpr size_t kChunkNodes = size_t(1) << 16;
+
+        struct Chunk {
+            std::unique_ptr<Node[]> data;
+            size_t capacity;
+            size_t used;
+        };
+
+        std::vector<Chunk> chunks;
+        size_t current = 0;
+    };
+
+    // Sorted vertex set living in the arena. Capacity may exceed size (X grows
+    // in place when vertices move from P to X).
+    struct NodeSet {
+        Node* data = nullptr;
+        size_t size = 0;
+        const Node* begin() const { return data; }
+        const Node* end() const { return data + size; }
+        bool empty() const { return size == 0; }
+    };
+
+    // Working state of one thread: arena, current clique R (push/pop), output sink, counters
+    struct Workspace {
+        NodeArena arena;
+        CliqueVec R;
+        std::vector<uint64_t> bitRows;  ///< Adjacency rows of the bitset kernel
+        CliqueSink* sink = nullptr;
+        std::unique_ptr<CliqueSink> forkedSink;  ///< Owns sink for parallel workers
+        bool featureAware = false;      ///< Collapse feature-multipartite branches (see tryFeatureShortcut)
+        std::vector<int> classSize;     ///< Scratch: instances per feature in P (all zero between uses)
+        size_t recursionNodes = 0;
+        size_t heapAllocations = 0;  ///< Arena chunks + R / bitRows regrowth
+        size_t reports = 0;          ///< Cliques handed to sink
+        size_t featureShortcuts = 0; ///< Branches collapsed by the feature-aware shortcut
+
+        NodeSet allocSet(size_t capacity) {
+            return { arena.allocate(capacity, heapAllocations), 0 };
+        }
+
+        void pushR(Node v) {
+            if (R.size() == R.capacity()) ++heapAllocations;
+            R.push_back(v);
+        }
+    };
+
+    // Shared state of a parallel run: large branches are handed to the pool and
+    // every worker uses its own Workspace (workspaces[worker])
+    struct ParallelContext {
+        WorkStealingPool* pool;
+        std::vector<Workspace>* workspaces;
+    };
+
+    // Sub-branches with at least this many candidates become tasks of their own
+    constexpr size_t kSpawnMinCandidates = 32;
 
     // --- HELPER FUNCTIONS (Set Operations) ---
 
+    // Các phép toán tập hợp dùng setops (SIMD / galloping, chọn kernel lúc chạy)
+
     // Đếm số phần tử chung (Intersection Size)
-    int count_intersection(const CliqueVec& A, const CliqueVec& B) {
-        int count = 0;
-        auto it1 = A.begin();
-        auto it2 = B.begin();
-        while (it1 != A.end() && it2 != B.end()) {
-            if (*it1 < *it2) ++it1;
-            else if (*it2 < *it1) ++it2;
-            else { ++count; ++it1; ++it2; }
-        }
-        return count;
+    template <typename RangeA, typename RangeB>
+    int count_intersection(const RangeA& A, const RangeB& B) {
+        return static_cast<int>(setops::intersectCount(
+            A.begin(), static_cast<size_t>(A.end() - A.begin()),
+            B.begin(), static_cast<size_t>(B.end() - B.begin())));
     }
 
-    // P \ N(u)
-    CliqueVec set_difference_helper(const CliqueVec& A, const CliqueVec& B) {
-        CliqueVec result;
-        result.reserve(A.size());
-        std::set_difference(A.begin(), A.end(), B.begin(), B.end(), std::back_inserter(result));
-        return result;
+    // out = A \ N(u); returns the result size
+    template <typename Range>
+    size_t set_difference_into(const NodeSet& A, const Range& B, Node* out) {
+        return setops::difference(A.begin(), A.size, B.begin(), B.size(), out);
     }
 
-    // P intersection N(u)
-    CliqueVec set_intersection_helper(const CliqueVec& A, const CliqueVec& B) {
-        CliqueVec result;
-        result.reserve(std::min(A.size(), B.size()));
-        std::set_intersection(A.begin(), A.end(), B.begin(), B.end(), std::back_inserter(result));
-        return result;
+    // out = A intersection N(u); returns the result size
+    template <typename Range>
+    size_t set_intersection_into(const NodeSet& A, const Range& B, Node* out) {
+        return setops::intersect(A.begin(), A.size, B.begin(), B.size(), out);
     }
 
-    // Hàm lưu kết quả vào Hashmap
-    void report_clique(const CliqueVec& R, ResultMap& hashMap) {
+    // Remove v from a sorted set (no-op if absent)
+    void erase_sorted(NodeSet& S, Node v) {
+        Node* it = std::lower_bound(S.data, S.data + S.size, v);
+        if (it != S.data + S.size && *it == v) {
+            std::copy(it + 1, S.data + S.size, it);
+            --S.size;
+        }
+    }
+
+    // Insert v into a sorted set; the caller guarantees spare capacity
+    void insert_sorted(NodeSet& S, Node v) {
+        Node* it = std::lower_bound(S.data, S.data + S.size, v);
+        std::copy_backward(it, S.data + S.size, S.data + S.size + 1);
+        *it = v;
+        ++S.size;
+    }
+
+    // Hàm gửi clique R hiện tại của workspace tới sink
+    void report_clique(Workspace& ws) {
+        const CliqueVec& R = ws.R;
         if (R.size() < 2) return;
+        ++ws.reports;
+        ws.sink->onClique(R.data(), R.size());
+    }
+
+    // --- FEATURE-AWARE SHORTCUT ---
+    // Cạnh chỉ nối các instance khác feature, nên mỗi clique có tối đa một instance mỗi feature.
+    // Nếu trong P mọi cặp đỉnh khác feature đều kề nhau (P là đồ thị đa phần đầy đủ theo lớp
+    // feature), các clique tối đại của nhánh là R + một instance từ mỗi lớp của P. Tất cả có
+    // cùng khóa F(R) U F(P) và cùng tập instance tham gia R U P. Một x trong X chỉ chặn được
+    // một clique như vậy nếu x kề ít nhất một đỉnh của MỌI lớp; nếu không có x nào như thế,
+    // cả nhánh được gộp thành một lần report R U P thay vì liệt kê tích các lớp.
+    //
+    // Vertices are passed around as handles (global id or local bit index):
+    // globalOf(h) = global id, degreeInP(h) = |P n N(h)|, featuresHitBy(h) = các feature của P n N(h).
+    template <typename ForEachP, typename ForEachX, typename GlobalOf, typename DegreeInP, typename FeaturesHitBy>
+    bool tryFeatureShortcut(Workspace& ws, size_t sizeP, const CSRGraph& graph,
+        ForEachP forEachP, ForEachX forEachX, GlobalOf globalOf, DegreeInP degreeInP, FeaturesHitBy featuresHitBy)
+    {
+        if (sizeP < 2) return false;
+        const FeatureType* featureOf = graph.instances->feature.data();
+
+        Colocation classes;
+        forEachP([&](auto u) {
+            FeatureType f = featureOf[globalOf(u)];
+            ws.classSize[f]++;
+            classes.insert(f);
+            return true;
+            });
+
+        // Mỗi u phải kề mọi đỉnh của P khác lớp với nó
+        bool multipartite = true;
+        forEachP([&](auto u) {
+            multipartite = degreeInP(u) == (int)sizeP - ws.classSize[featureOf[globalOf(u)]];
+            return multipartite;
+            });
+
+        bool allMaximal = multipartite;
+        if (multipartite) {
+            size_t numClasses = classes.size();
+            forEachX([&](auto x) {
+                allMaximal = featuresHitBy(x).size() < numClasses;
+                return allMaximal;
+                });
+        }
+
+        for (FeatureType f : classes) ws.classSize[f] = 0;
+        if (!allMaximal) return false;
+
+        size_t rSize = ws.R.size();
+        forEachP([&](auto u) { ws.pushR(globalOf(u)); return true; });
+        report_clique(ws);
+        ws.R.resize(rSize);
+        ++ws.featureShortcuts;
+        return true;
+    }
+
+    // Shortcut on the sorted-vector sets
+    bool tryFeatureShortcut(Workspace& ws, const NodeSet& P, const NodeSet& X, const CSRGraph& graph) {
+        const FeatureType* featureOf = graph.instances->feature.data();
+        auto forEachIn = [](const NodeSet& S) {
+            return [&S](auto fn) {
+                for (Node u : S) if (!fn(u)) return;
+                };
+            };
+        auto degreeInP = [&](Node u) {
+            return count_intersection(P, neighborsOf(graph, u));
+            };
+        auto featuresHitBy = [&](Node x) {
+            NodeArena::Mark mark = ws.arena.mark();
+            NeighborRow neighbors_x = neighborsOf(graph, x);
+            NodeSet hit = ws.allocSet(std::min(P.size, neighbors_x.size()));
+            hit.size = setops::intersect(P.begin(), P.size, neighbors_x.begin(), neighbors_x.size(), hit.data);
+            Colocation features;
+            for (Node u : hit) features.insert(featureOf[u]);
+            ws.arena.release(mark);
+            return features;
+            };
+        auto globalOf = [](Node u) { return u; };
+        return tryFeatureShortcut(ws, P.size, graph, forEachIn(P), forEachIn(X), globalOf, degreeInP, featuresHitBy);
+    }
+
+    void runBKPivot(Workspace& ws, NodeSet P, NodeSet X, const CSRGraph& graph, const ParallelContext* par);
+    void runBKRcd(Workspace& ws, NodeSet P, NodeSet X, const CSRGraph& graph, const ParallelContext* par);
+
+    // --- BITSET KERNEL (small subproblems) ---
+    // Khi |P U X| nhỏ (<= 64 hoặc <= 256), đồ thị con cảm sinh bởi P U X được đánh lại
+    // chỉ số cục bộ 0..n-1 (giữ thứ tự id toàn cục) và lưu thành các hàng kề dạng bit.
+    // Pivot/RCD chạy bằng AND/ANDN + popcount trên từng word. Thứ tự duyệt và cách chọn
+    // pivot / u_worst giống hệt bản sorted-vector nên tập clique báo cáo không đổi.
+
+    template <size_t Words>
+    using BitRow = std::array<uint64_t, Words>;
+
+    template <size_t Words>
+    bool rowEmpty(const BitRow<Words>& a) {
+        for (size_t i = 0; i < Words; ++i) if (a[i]) return false;
+        return true;
+    }
+
+    template <size_t Words>
+    int rowCount(const BitRow<Words>& a) {
+        int n = 0;
+        for (size_t i = 0; i < Words; ++i) n += bits::popcount(a[i]);
+        return n;
+    }
+
+    // Hàng kề b được đọc trực tiếp từ bộ đệm (Words word liên tiếp)
+
+    // |a n b|
+    template <size_t Words>
+    int rowAndCount(const BitRow<Words>& a, const uint64_t* b) {
+        int n = 0;
+        for (size_t i = 0; i < Words; ++i) n += bits::popcount(a[i] & b[i]);
+        return n;
+    }
+
+    template <size_t Words>
+    BitRow<Words> rowAnd(const BitRow<Words>& a, const uint64_t* b) {
+        BitRow<Words> r;
+        for (size_t i = 0; i < Words; ++i) r[i] = a[i] & b[i];
+        return r;
+    }
+
+    // a \ b
+    template <size_t Words>
+    BitRow<Words> rowAndNot(const BitRow<Words>& a, const uint64_t* b) {
+        BitRow<Words> r;
+        for (size_t i = 0; i < Words; ++i) r[i] = a[i] & ~b[i];
+        return r;
+    }
+
+    template <size_t Words>
+    void rowSet(BitRow<Words>& a, int i) { a[i >> 6] |= uint64_t(1) << (i & 63); }
+
+    inline void rowSet(uint64_t* a, int i) { a[i >> 6] |= uint64_t(1) << (i & 63); }
+
+    template <size_t Words>
+    void rowReset(BitRow<Words>& a, int i) { a[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+
+    // Call fn(local index) for every set bit in ascending order
+    template <size_t Words, typename Fn>
+    void rowForEach(const BitRow<Words>& a, Fn fn) {
+        for (size_t w = 0; w < Words; ++w) {
+            uint64_t word = a[w];
+            while (word) {
+                fn(static_cast<int>(w * 64) + bits::lowestBit(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    // Đồ thị con cục bộ: local -> global (tăng dần) và hàng kề của từng đỉnh cục bộ
+    template <size_t Words>
+    struct LocalSubgraph {
+        const Node* vertices;
+        const uint64_t* rows;  ///< n x Words words
+        const uint64_t* adjacency(int u) const { return rows + static_cast<size_t>(u) * Words; }
+    };
+
+    // Shortcut on the local bit-rows
+    template <size_t Words>
+    bool tryFeatureShortcut(Workspace& ws, const LocalSubgraph<Words>& sub, const BitRow<Words>& P,
+        const BitRow<Words>& X, const CSRGraph& graph)
+    {
+        const FeatureType* featureOf = graph.instances->feature.data();
+        auto forEachIn = [](const BitRow<Words>& S) {
+            return [&S](auto fn) {
+                bool go = true;
+                rowForEach<Words>(S, [&](int u) { if (go) go = fn(u); });
+                };
+            };
+        auto globalOf = [&sub](int u) { return sub.vertices[u]; };
+        auto degreeInP = [&](int u) {
+            return rowAndCount<Words>(P, sub.adjacency(u));
+            };
+        auto featuresHitBy = [&](int x) {
+            Colocation features;
+            rowForEach<Words>(rowAnd<Words>(P, sub.adjacency(x)), [&](int u) {
+                features.insert(featureOf[sub.vertices[u]]);
+                });
+            return features;
+            };
+        return tryFeatureShortcut(ws, (size_t)rowCount<Words>(P), graph, forEachIn(P), forEachIn(X), globalOf, degreeInP, featuresHitBy);
+    }
+
+    template <size_t Words>
+    void runBitsetPivot(Workspace& ws, const LocalSubgraph<Words>& sub, BitRow<Words> P, BitRow<Words> X,
+        const CSRGraph& graph)
+    {
+        ++ws.recursionNodes;
+        bool emptyP = rowEmpty<Words>(P);
+        if (emptyP && rowEmpty<Words>(X)) {
+            report_clique(ws);
+            return;
+        }
+        if (emptyP) return;
+        if (ws.featureAware && tryFeatureShortcut<Words>(ws, sub, P, X, graph)) return;
+
+        // Pivot maximizing |P n N(u)|, P trước rồi X (như bản sorted-vector)
+        int u_pivot = -1;
+        int max_inter = -1;
+        auto check_pivot = [&](int candidate) {
+            int inter_size = rowAndCount<Words>(P, sub.adjacency(candidate));
+            if (inter_size > max_inter) {
+                max_inter = inter_size;
+                u_pivot = candidate;
+            }
+            };
+        rowForEach<Words>(P, check_pivot);
+        rowForEach<Words>(X, check_pivot);
+
+        BitRow<Words> candidates = rowAndNot<Words>(P, sub.adjacency(u_pivot));
+        rowForEach<Words>(candidates, [&](int v) {
+            ws.pushR(sub.vertices[v]);
+            runBitsetPivot<Words>(ws, sub, rowAnd<Words>(P, sub.adjacency(v)), rowAnd<Words>(X, sub.adjacency(v)), graph);
+            ws.R.pop_back();
+
+            rowReset<Words>(P, v);
+            rowSet<Words>(X, v);
+            });
+    }
+
+    template <size_t Words>
+    void runBitsetRcd(Workspace& ws, const LocalSubgraph<Words>& sub, BitRow<Words> P, BitRow<Words> X,
+        const CSRGraph& graph)
+    {
+        ++ws.recursionNodes;
+        if (rowEmpty<Words>(P) && rowEmpty<Words>(X)) {
+            report_clique(ws);
+            return;
+        }
+        if (ws.featureAware && tryFeatureShortcut<Words>(ws, sub, P, X, graph)) return;
+
+        while (true) {
+            int sizeP = rowCount<Words>(P);
+            bool isClique = true;
+            int u_worst = -1;
+            int min_degree_in_P = 2147483647; // INT_MAX
+
+            rowForEach<Words>(P, [&](int u) {
+                int deg_in_P = rowAndCount<Words>(P, sub.adjacency(u));
+                if (deg_in_P < sizeP - 1) isClique = false;
+                if (deg_in_P < min_degree_in_P) {
+                    min_degree_in_P = deg_in_P;
+                    u_worst = u;
+                }
+                });
+
+            if (isClique) {
+                // x chặn P nếu x nối với tất cả đỉnh của P (P \ N(x) rỗng)
+                bool isMaximal = true;
+                if (sizeP > 0) {
+                    rowForEach<Words>(X, [&](int x) {
+                        if (isMaximal && rowEmpty<Words>(rowAndNot<Words>(P, sub.adjacency(x)))) isMaximal = false;
+                        });
+                }
+                if (isMaximal) {
+                    size_t rSize = ws.R.size();
+                    rowForEach<Words>(P, [&](int u) { ws.pushR(sub.vertices[u]); });
+                    report_clique(ws);
+                    ws.R.resize(rSize);
+                }
+                return;
+            }
+
+            ws.pushR(sub.vertices[u_worst]);
+            runBitsetRcd<Words>(ws, sub, rowAnd<Words>(P, sub.adjacency(u_worst)), rowAnd<Words>(X, sub.adjacency(u_worst)), graph);
+            ws.R.pop_back();
+
+            rowReset<Words>(P, u_worst);
+            rowSet<Words>(X, u_worst);
+            if (rowEmpty<Words>(P)) return;
+        }
+    }
+
+    // Remap P U X to local indices, build the adjacency bit-rows in the workspace
+    // and run pivot or RCD on them. Requires |P| + |X| <= Words * 64.
+    template <size_t Words>
+    void runBitsetKernel(Workspace& ws, const NodeSet& P, const NodeSet& X, bool rcd, const CSRGraph& graph) {
+        size_t n = P.size + X.size;
+        NodeArena::Mark frame = ws.arena.mark();
+
+        // Merge P and X (both sorted, disjoint) into the local vertex list
+        NodeSet local = ws.allocSet(n);
+        BitRow<Words> localP{}, localX{};
+        size_t ip = 0, ix = 0;
+        while (ip < P.size || ix < X.size) {
+            int li = static_cast<int>(local.size);
+            if (ix == X.size || (ip < P.size && P.data[ip] < X.data[ix])) {
+                local.data[local.size++] = P.data[ip++];
+                rowSet<Words>(localP, li);
+            }
+            else {
+                local.data[local.size++] = X.data[ix++];
+                rowSet<Words>(localX, li);
+            }
+        }
+
+        // Adjacency rows: N(u) n (P U X), merged against the sorted local list
+        if (ws.bitRows.capacity() < n * Words) ++ws.heapAllocations;
+        ws.bitRows.assign(n * Words, 0);
+
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t* row = ws.bitRows.data() + i * Words;
+            NeighborRow neighbors = neighborsOf(graph, local.data[i]);
+            const Node* it = neighbors.begin();
+            for (size_t j = 0; j < n && it != neighbors.end(); ++j) {
+                it = std::lower_bound(it, neighbors.end(), local.data[j]);
+                if (it != neighbors.end() && *it == local.data[j]) rowSet(row, static_cast<int>(j));
+            }
+        }
+
+        LocalSubgraph<Words> sub{ local.data, ws.bitRows.data() };
+        if (rcd) runBitsetRcd<Words>(ws, sub, localP, localX, graph);
+        else runBitsetPivot<Words>(ws, sub, localP, localX, graph);
+
+        ws.arena.release(frame);
+    }
+
+    // Chạy bằng bitset kernel nếu P U X đủ nhỏ; trả về false nếu không áp dụng được
+    bool tryBitsetKernel(Workspace& ws, const NodeSet& P, const NodeSet& X, bool rcd, const CSRGraph& graph) {
+        size_t n = P.size + X.size;
+        if (n <= 64) runBitsetKernel<1>(ws, P, X, rcd, graph);
+        else if (n <= 256) runBitsetKernel<4>(ws, P, X, rcd, graph);
+        else return false;
+        return true;
+    }
+
+
+    // Run a branch handed over by another thread: copy its sets into this worker's
+    // workspace (X gets room for every vertex of P) and recurse from there
+    void runBranchTask(
+        Workspace& ws,
+        const CliqueVec& R,
+        const CliqueVec& P,
+        const CliqueVec& X,
+        bool rcd,
+        const CSRGraph& graph,
+        const ParallelContext* par)
+    {
+        ws.R.assign(R.begin(), R.end());
+        NodeArena::Mark frame = ws.arena.mark();
+
+        NodeSet taskP = ws.allocSet(P.size());
+        taskP.size = static_cast<size_t>(std::copy(P.begin(), P.end(), taskP.data) - taskP.data);
+        NodeSet taskX = ws.allocSet(X.size() + P.size());
+        taskX.size = static_cast<size_t>(std::copy(X.begin(), X.end(), taskX.data) - taskX.data);
+
+        if (rcd) runBKRcd(ws, taskP, taskX, graph, par);
+        else runBKPivot(ws, taskP, taskX, graph, par);
 
-        Colocation colocationKey;
-        colocationKey.reserve(R.size());
-        for (const auto& instancePtr : R) {
-            colocationKey.push_back(instancePtr->type);
+        ws.arena.release(frame);
+        ws.R.clear();
+    }
+
+    // Child sets of branch v: newP = P n N(v), newX = X n N(v) with room for newP
+    void makeChildSets(Workspace& ws, const NodeSet& P, const NodeSet& X, NeighborRow neighbors_v,
+        NodeSet& newP, NodeSet& newX)
+    {
+        newP = ws.allocSet(std::min(P.size, neighbors_v.size()));
+        newP.size = set_intersection_into(P, neighbors_v, newP.data);
+        newX = ws.allocSet(std::min(X.size, neighbors_v.size()) + newP.size);
+        newX.size = set_intersection_into(X, neighbors_v, newX.data);
+    }
+
+    // Recurse into a child branch with v added to R, or hand it to the pool if large
+    void recurseOrSpawn(Workspace& ws, Node v, const NodeSet& newP, const NodeSet& newX, bool rcd,
+        const CSRGraph& graph, const ParallelContext* par)
+    {
+        if (newP.size + newX.size <= 64) {
+            // Nhánh nhỏ: chuyển sang bitset kernel
+            ws.pushR(v);
+            tryBitsetKernel(ws, newP, newX, rcd, graph);
+            ws.R.pop_back();
+            return;
         }
-        std::sort(colocationKey.begin(), colocationKey.end());
 
-        auto& innerMap = hashMap[colocationKey];
-        for (const auto& instancePtr : R) {
-            innerMap[instancePtr->type].insert(instancePtr);
+        if (par && newP.size >= kSpawnMinCandidates) {
+            // Nhánh lớn: giao cho pool để worker rảnh có thể steal
+            CliqueVec taskR = ws.R;
+            taskR.push_back(v);
+            CliqueVec taskP(newP.begin(), newP.end());
+            CliqueVec taskX(newX.begin(), newX.end());
+            par->pool->submit([taskR, taskP, taskX, rcd, &graph, par](unsigned worker) {
+                runBranchTask((*par->workspaces)[worker], taskR, taskP, taskX, rcd, graph, par);
+                });
+            return;
         }
+
+        ws.pushR(v);
+        if (rcd) runBKRcd(ws, newP, newX, graph, par);
+        else runBKPivot(ws, newP, newX, graph, par);
+        ws.R.pop_back();
     }
 
     // --- ALGORITHM 1: BK PIVOT (Standard) ---
+    // R nằm trong ws.R; P, X nằm trong arena của ws (X có đủ chỗ cho mọi đỉnh của P)
     void runBKPivot(
-        CliqueVec R,
-        CliqueVec P,
-        CliqueVec X,
-        const AdjMap& adj,
-        ResultMap& hashMap)
+        Workspace& ws,
+        NodeSet P,
+        NodeSet X,
+        const CSRGraph& graph,
+        const ParallelContext* par)
     {
+        ++ws.recursionNodes;
         if (P.empty() && X.empty()) {
-            report_clique(R, hashMap);
+            report_clique(ws);
             return;
         }
         if (P.empty()) return;
+        if (ws.featureAware && tryFeatureShortcut(ws, P, X, graph)) return;
 
         // 1. Select Pivot u in P U X maximizing |P n N(u)|
-        Node u_pivot = nullptr;
+        Node u_pivot = -1;
         int max_inter = -1;
 
         auto check_pivot = [&](Node candidate) {
-            auto it = adj.find(candidate);
-            if (it != adj.end()) {
-                int inter_size = count_intersection(P, it->second);
-                if (inter_size > max_inter) {
-                    max_inter = inter_size;
-                    u_pivot = candidate;
-                }
+            int inter_size = count_intersection(P, neighborsOf(graph, candidate));
+            if (inter_size > max_inter) {
+                max_inter = inter_size;
+                u_pivot = candidate;
             }
             };
 
         for (Node node : P) check_pivot(node);
         for (Node node : X) check_pivot(node);
 
+        NodeArena::Mark frame = ws.arena.mark();
+
         // 2. Candidates = P \ N(pivot)
-        CliqueVec candidates;
-        if (u_pivot != nullptr) {
-            auto it = adj.find(u_pivot);
-            if (it != adj.end()) {
-                candidates = set_difference_helper(P, it->second);
-            }
-            else {
-                candidates = P;
-            }
+        NodeSet candidates = ws.allocSet(P.size);
+        if (u_pivot != -1) {
+            candidates.size = set_difference_into(P, neighborsOf(graph, u_pivot), candidates.data);
         }
         else {
-            candidates = P;
+            candidates.size = static_cast<size_t>(std::copy(P.begin(), P.end(), candidates.data) - candidates.data);
         }
 
         // 3. Recurse
         for (Node v : candidates) {
-            CliqueVec newR = R;
-            newR.push_back(v);
-
-            CliqueVec neighbors_v;
-            auto it = adj.find(v);
-            if (it != adj.end()) neighbors_v = it->second;
-
-            runBKPivot(
-                newR,
-                set_intersection_helper(P, neighbors_v),
-                set_intersection_helper(X, neighbors_v),
-                adj, hashMap
-            );
+            NodeArena::Mark child = ws.arena.mark();
+            NodeSet newP, newX;
+            makeChildSets(ws, P, X, neighborsOf(graph, v), newP, newX);
+            recurseOrSpawn(ws, v, newP, newX, false, graph, par);
+            ws.arena.release(child);
 
             // Backtrack: Move v from P to X
-            auto itP = std::lower_bound(P.begin(), P.end(), v);
-            if (itP != P.end() && *itP == v) P.erase(itP);
-
-            auto itX = std::lower_bound(X.begin(), X.end(), v);
-            X.insert(itX, v);
+            erase_sorted(P, v);
+            insert_sorted(X, v);
         }
+
+        ws.arena.release(frame);
     }
 
     // --- ALGORITHM 2: BK RCD (Recursive Core Decomposition) ---
     // Được sử dụng cho các vùng "đặc" (dense neighborhoods)
     void runBKRcd(
-        CliqueVec R,
-        CliqueVec P,
-        CliqueVec X,
-        const AdjMap& adj,
-        ResultMap& hashMap)
+        Workspace& ws,
+        NodeSet P,
+        NodeSet X,
+        const CSRGraph& graph,
+        const ParallelContext* par)
     {
+        ++ws.recursionNodes;
         if (P.empty() && X.empty()) {
-            report_clique(R, hashMap);
+            report_clique(ws);
             return;
         }
+        if (ws.featureAware && tryFeatureShortcut(ws, P, X, graph)) return;
 
         // Loop Decomposition: Tiếp tục loại bỏ đỉnh cho đến khi P là Clique
         while (true) {
@@ -163,21 +654,17 @@ namespace {
             // Trong ngữ cảnh này: Bậc thấp nhất trong P <=> Có nhiều non-neighbor nhất trong P
 
             bool isClique = true;
-            Node u_worst = nullptr;
+            Node u_worst = -1;
             int min_degree_in_P = 2147483647; // INT_MAX
 
             // Duyệt qua tất cả đỉnh trong P để tính bậc nội bộ
             for (Node u : P) {
                 // Tính bậc của u trong subgraph P (giao của N(u) và P)
-                auto itAdj = adj.find(u);
-                int deg_in_P = 0;
-                if (itAdj != adj.end()) {
-                    deg_in_P = count_intersection(P, itAdj->second);
-                }
+                int deg_in_P = count_intersection(P, neighborsOf(graph, u));
 
                 // Nếu có bất kỳ đỉnh nào không nối với tất cả đỉnh còn lại (bậc < |P| - 1)
                 // thì P chưa phải là Clique.
-                if (deg_in_P < (int)P.size() - 1) {
+                if (deg_in_P < (int)P.size - 1) {
                     isClique = false;
                 }
 
@@ -195,18 +682,8 @@ namespace {
                 bool isMaximal = true;
                 if (!P.empty()) {
                     for (Node x : X) {
-                        bool connectedToAll = true;
-                        auto itAdjX = adj.find(x);
-                        const CliqueVec& neighbors_x = (itAdjX != adj.end()) ? itAdjX->second : CliqueVec();
-
-                        // Check if neighbors_x contains all of P
-                        // Vì cả 2 đều sorted, có thể check nhanh, nhưng ở đây dùng count_intersection cho đơn giản
                         // Nếu intersection(P, N(x)) == |P| -> x nối hết với P
-                        if (count_intersection(P, neighbors_x) != (int)P.size()) {
-                            connectedToAll = false;
-                        }
-
-                        if (connectedToAll) {
+                        if (count_intersection(P, neighborsOf(graph, x)) == (int)P.size) {
                             isMaximal = false;
                             break; // P bị chặn bởi x
                         }
@@ -214,10 +691,11 @@ namespace {
                 }
 
                 if (isMaximal) {
-                    // Output R U P
-                    CliqueVec resultClique = R;
-                    resultClique.insert(resultClique.end(), P.begin(), P.end());
-                    report_clique(resultClique, hashMap);
+                    // Output R U P (tạm thời nối P vào R rồi khôi phục)
+                    size_t rSize = ws.R.size();
+                    for (Node u : P) ws.pushR(u);
+                    report_clique(ws);
+                    ws.R.resize(rSize);
                 }
                 return; // Kết thúc nhánh này
             }
@@ -226,26 +704,16 @@ namespace {
             // Chọn u_worst (đỉnh có nhiều non-neighbor nhất)
 
             // a. Gọi đệ quy với u_worst được bao gồm
-            CliqueVec newR = R;
-            newR.push_back(u_worst);
-
-            auto itAdj = adj.find(u_worst);
-            const CliqueVec& neighbors_u = (itAdj != adj.end()) ? itAdj->second : CliqueVec();
-
-            runBKRcd(
-                newR,
-                set_intersection_helper(P, neighbors_u),
-                set_intersection_helper(X, neighbors_u),
-                adj, hashMap
-            );
+            NodeArena::Mark child = ws.arena.mark();
+            NodeSet newP, newX;
+            makeChildSets(ws, P, X, neighborsOf(graph, u_worst), newP, newX);
+            recurseOrSpawn(ws, u_worst, newP, newX, true, graph, par);
+            ws.arena.release(child);
 
             // b. Loại bỏ u_worst khỏi P và thêm vào X cho vòng lặp while tiếp theo
             // (Tương đương P = P \ {u}, X = X U {u})
-            auto itP = std::lower_bound(P.begin(), P.end(), u_worst);
-            if (itP != P.end() && *itP == u_worst) P.erase(itP);
-
-            auto itX = std::lower_bound(X.begin(), X.end(), u_worst);
-            X.insert(itX, u_worst);
+            erase_sorted(P, u_worst);
+            insert_sorted(X, u_worst);
 
             // Nếu P rỗng thì dừng
             if (P.empty()) return;
@@ -259,8 +727,8 @@ namespace {
         int k; // Shell size
     };
 
-    StructureInfo analyzeStructure(const CliqueVec& P, const AdjMap& adj) {
-        int n_sub = (int)P.size();
+    StructureInfo analyzeStructure(const NodeSet& P, const CSRGraph& graph) {
+        int n_sub = (int)P.size;
         if (n_sub == 0) return { 0, 0 };
 
         int s = 0;
@@ -268,11 +736,7 @@ namespace {
 
         for (Node u : P) {
             // Tính bậc trong P
-            auto it = adj.find(u);
-            int deg_in_P = 0;
-            if (it != adj.end()) {
-                deg_in_P = count_intersection(P, it->second);
-            }
+            int deg_in_P = count_intersection(P, neighborsOf(graph, u));
 
             // Nếu nối với tất cả (trừ chính nó) -> thuộc S
             if (deg_in_P == n_sub - 1) {
@@ -286,124 +750,99 @@ namespace {
     }
 
     // --- DEGENERACY ORDERING ---
-    // Tính thứ tự suy biến của đồ thị
-    std::vector<Node> getDegeneracyOrdering(const AdjMap& adj) {
-        // 1. Tính bậc ban đầu
-        std::unordered_map<Node, int> degrees;
-        // Bucket sort: max degree < N. Dùng vector<vector<Node>> làm bucket
-        // Tuy nhiên vì Node là pointer, max degree có thể lớn bằng số instance.
-        // Để đơn giản và an toàn bộ nhớ, ta dùng set<pair<degree, Node>> để luôn lấy min.
-        // Độ phức tạp O(M log N), đủ tốt. (Linear O(N+M) bucket sort phức tạp hơn chút để implement)
-
-        std::set<std::pair<int, Node>> sortedNodes;
-
-        for (const auto& entry : adj) {
-            int d = (int)entry.second.size();
-            degrees[entry.first] = d;
-            sortedNodes.insert({ d, entry.first });
-        }
-
-        std::vector<Node> ordering;
-        ordering.reserve(adj.size());
-
-        // Theo dõi các node đã bị xóa
-        std::set<Node> removed;
-
-        // 2. Core Decomposition
-        while (!sortedNodes.empty()) {
-            // Lấy đỉnh có bậc nhỏ nhất
-            auto it = sortedNodes.begin();
-            Node u = it->second;
-            sortedNodes.erase(it);
-
-            ordering.push_back(u);
-            removed.insert(u);
-
-            // Giảm bậc các lân cận
-            auto itAdj = adj.find(u);
-            if (itAdj != adj.end()) {
-                for (Node v : itAdj->second) {
-                    if (removed.find(v) != removed.end()) continue; // Đã xóa v rồi thì bỏ qua
-
-                    // Cập nhật v trong sortedNodes
-                    int old_deg = degrees[v];
-                    auto searchPair = sortedNodes.find({ old_deg, v });
-                    if (searchPair != sortedNodes.end()) {
-                        sortedNodes.erase(searchPair);
-                        degrees[v] = old_deg - 1;
-                        sortedNodes.insert({ old_deg - 1, v });
+    // Tính thứ tự suy biến bằng thuật toán Batagelj-Zaversnik (bucket sort, O(N + M)).
+    // Mảng phẳng theo id đỉnh:
+    //   vert: các đỉnh xếp theo bậc hiện tại (cũng chính là thứ tự suy biến khi kết thúc)
+    //   pos:  vị trí của mỗi đỉnh trong vert
+    //   bin:  vị trí bắt đầu của mỗi bậc trong vert
+    // coreNumbers[v] nhận core number của v.
+    std::vector<Node> getDegeneracyOrdering(const CSRGraph& graph, std::vector<int>& coreNumbers) {
+        Node numNodes = (Node)graph.numVertices();
+        std::vector<int>& deg = coreNumbers;
+        deg.assign(numNodes, 0);
+
+        // 1. Bậc ban đầu
+        int maxDeg = 0;
+        for (Node u = 0; u < numNodes; ++u) {
+            deg[u] = (int)graph.degree(u);
+            maxDeg = std::max(maxDeg, deg[u]);
+        }
+
+        // 2. Bucket sort theo bậc
+        std::vector<Node> bin(maxDeg + 1, 0);
+        for (Node u = 0; u < numNodes; ++u) bin[deg[u]]++;
+        Node start = 0;
+        for (int d = 0; d <= maxDeg; ++d) {
+            Node count = bin[d];
+            bin[d] = start;
+            start += count;
+        }
+
+        std::vector<Node> vert(numNodes);
+        std::vector<Node> pos(numNodes);
+        for (Node u = 0; u < numNodes; ++u) {
+            pos[u] = bin[deg[u]]++;
+            vert[pos[u]] = u;
+        }
+        for (int d = maxDeg; d > 0; --d) bin[d] = bin[d - 1];
+        bin[0] = 0;
+
+        // 3. Core Decomposition: lấy đỉnh có bậc nhỏ nhất, giảm bậc các lân cận chưa xóa
+        for (Node i = 0; i < numNodes; ++i) {
+            Node v = vert[i];
+            for (Node u : neighborsOf(graph, v)) {
+                if (deg[u] > deg[v]) {
+                    // Đổi chỗ u với đỉnh đầu tiên trong bucket của nó, rồi thu hẹp bucket
+                    int du = deg[u];
+                    Node pu = pos[u];
+                    Node pw = bin[du];
+                    Node w = vert[pw];
+                    if (u != w) {
+                        pos[u] = pw; vert[pu] = w;
+                        pos[w] = pu; vert[pw] = u;
                     }
+                    bin[du]++;
+                    deg[u]--;
                 }
             }
         }
-        return ordering;
-    }
-}
-
-// ============================================================================
-// PUBLIC METHODS IMPLEMENTATION
-// ============================================================================
-
-std::map<Colocation, std::unordered_map<FeatureType, std::set<const SpatialInstance*>>> MaximalCliqueHashmap::executeBK(
-    const std::vector<NeighborSet>& neighborSets) {
-
-    // --- Step 1: Build Adjacency Map Directly ---
-    AdjMap adj;
-    adj.reserve(neighborSets.size());
-
-    // Thu thập tất cả các nodes
-    for (const auto& ns : neighborSets) {
-        Node u = ns.center;
-        CliqueVec sorted_neighbors = ns.neighbors;
-        std::sort(sorted_neighbors.begin(), sorted_neighbors.end());
-        adj[u] = std::move(sorted_neighbors);
-    }
-
-    // --- Step 2: Compute Degeneracy Ordering ---
-    std::vector<Node> ordering = getDegeneracyOrdering(adj);
-
-    // --- Step 3: Iterate in Degeneracy Order ---
-    // MCE Degeneracy Logic:
-    // Với mỗi đỉnh v trong thứ tự suy biến:
-    // P = N(v) giao {các đỉnh đứng SAU v trong thứ tự}
-    // X = N(v) giao {các đỉnh đứng TRƯỚC v trong thứ tự}
-
-    // Để tra cứu nhanh "đứng sau/trước", ta map Node -> index trong ordering
-    std::unordered_map<Node, int> orderIndex;
-    for (int i = 0; i < (int)ordering.size(); ++i) {
-        orderIndex[ordering[i]] = i;
+        return vert;
     }
 
-    ResultMap hashMap;
-
-    for (int i = 0; i < (int)ordering.size(); ++i) {
+    // --- PER-VERTEX SUBPROBLEM ---
+    // Liệt kê các clique tối đại có đỉnh đầu tiên (theo thứ tự suy biến) là ordering[i]
+    void enumerateFromVertex(
+        int i,
+        const std::vector<Node>& ordering,
+        const std::vector<int>& orderIndex,
+        const CSRGraph& graph,
+        Workspace& ws,
+        const ParallelContext* par)
+    {
         Node v = ordering[i];
 
         // Lấy hàng xóm của v
-        auto itAdj = adj.find(v);
-        if (itAdj == adj.end()) continue;
-        const CliqueVec& neighbors = itAdj->second;
+        NeighborRow neighbors = neighborsOf(graph, v);
 
         // Phân loại hàng xóm vào P (sau) và X (trước)
-        CliqueVec P, X;
-        P.reserve(neighbors.size());
-        X.reserve(neighbors.size());
+        // X được cấp đủ chỗ cho |X| + |P| = deg(v) vì các đỉnh của P sẽ chuyển dần sang X
+        NodeArena::Mark frame = ws.arena.mark();
+        NodeSet P = ws.allocSet(neighbors.size());
+        NodeSet X = ws.allocSet(neighbors.size());
 
+        // CSR rows are sorted, so P and X come out sorted for the set intersections below
         for (Node neighbor : neighbors) {
             if (orderIndex[neighbor] > i) {
-                P.push_back(neighbor);
+                P.data[P.size++] = neighbor;
             }
             else {
-                X.push_back(neighbor);
+                X.data[X.size++] = neighbor;
             }
         }
-        // P và X cần được sort để dùng cho set intersection trong các bước sau
-        std::sort(P.begin(), P.end());
-        std::sort(X.begin(), X.end());
 
         // --- HYBRID SWITCH ---
         // Phân tích cấu trúc của đồ thị con P
-        StructureInfo info = analyzeStructure(P, adj);
+        StructureInfo info = analyzeStructure(P, graph);
 
         // Điều kiện chọn thuật toán (từ paper: s >= 2.8k - 11)
         // RCD tốt cho vùng đặc (s lớn, k nhỏ)
@@ -411,23 +850,118 @@ std::map<Colocation, std::unordered_map<FeatureType, std::set<const SpatialInsta
         double threshold = 2.8 * info.k - 11.0;
 
         // R khởi tạo chứa {v}
-        CliqueVec R_init = { v };
+        ws.R.clear();
+        ws.pushR(v);
+
+        bool useRcd = info.s >= threshold;
 
-        if (info.s >= threshold) {
+        if (tryBitsetKernel(ws, P, X, useRcd, graph)) {
+            // P U X nhỏ: đã chạy bằng bitset kernel
+        }
+        else if (useRcd) {
             // Gọi BK RCD
-            runBKRcd(R_init, P, X, adj, hashMap);
+            runBKRcd(ws, P, X, graph, par);
         }
         else {
             // Gọi BK Pivot
-            runBKPivot(R_init, P, X, adj, hashMap);
+            runBKPivot(ws, P, X, graph, par);
         }
+
+        ws.R.clear();
+        ws.arena.release(frame);
+    }
+}
+
+// ============================================================================
+// PUBLIC METHODS IMPLEMENTATION
+// ============================================================================
+
+void MaximalCliqueHashmap::enumerate(
+    const CSRGraph& graph,
+    CliqueSink& sink) {
+
+    // --- Step 1: Adjacency ---
+    // CSR rows are already sorted by vertex id, so they are used directly as N(u)
+
+    // --- Step 2: Compute Degeneracy Ordering ---
+    std::vector<Node> ordering = getDegeneracyOrdering(graph, degeneracyInfo.coreNumbers);
+    degeneracyInfo.degeneracy = 0;
+    for (int core : degeneracyInfo.coreNumbers) {
+        degeneracyInfo.degeneracy = std::max(degeneracyInfo.degeneracy, core);
     }
 
+    // --- Step 3: Iterate in Degeneracy Order ---
+    // MCE Degeneracy Logic:
+    // Với mỗi đỉnh v trong thứ tự suy biến:
+    // P = N(v) giao {các đỉnh đứng SAU v trong thứ tự}
+    // X = N(v) giao {các đỉnh đứng TRƯỚC v trong thứ tự}
+
+    // Để tra cứu nhanh "đứng sau/trước", ta map Node -> index trong ordering
+    std::vector<int> orderIndex(ordering.size());
+    for (int i = 0; i < (int)ordering.size(); ++i) {
+        orderIndex[ordering[i]] = i;
+    }
+
+    // Một Workspace cho mỗi thread. R không bao giờ vượt quá degeneracy + 1 đỉnh,
+    // nên cấp trước để push/pop không cấp phát lại.
+    std::vector<Workspace> workspaces(numThreads);
+    for (auto& ws : workspaces) {
+        ws.R.reserve(static_cast<size_t>(degeneracyInfo.degeneracy) + 2);
+        ws.featureAware = featureAware;
+        ws.classSize.assign(Colocation::kCapacity, 0);
+    }
+
+    if (numThreads <= 1) {
+        workspaces[0].sink = &sink;
+        for (int i = 0; i < (int)ordering.size(); ++i) {
+            enumerateFromVertex(i, ordering, orderIndex, graph, workspaces[0], nullptr);
+        }
+    }
+    else {
+        // Parallel: mỗi đỉnh là một task, các nhánh đệ quy lớn được tách thành task con.
+        // Mỗi worker ghi vào sink riêng (fork), gộp lại ở cuối theo thứ tự worker.
+        for (auto& ws : workspaces) {
+            ws.forkedSink = sink.fork();
+            ws.sink = ws.forkedSink.get();
+        }
+
+        WorkStealingPool pool(numThreads);
+        ParallelContext par{ &pool, &workspaces };
+        const ParallelContext* parPtr = &par;
+
+        for (int i = 0; i < (int)ordering.size(); ++i) {
+            pool.submit([i, &ordering, &orderIndex, &graph, parPtr](unsigned worker) {
+                enumerateFromVertex(i, ordering, orderIndex, graph, (*parPtr->workspaces)[worker], parPtr);
+                });
+        }
+        pool.wait();
+    }
+
+    enumerationStats = EnumerationStats();
+    for (const auto& ws : workspaces) {
+        enumerationStats.recursionNodes += ws.recursionNodes;
+        enumerationStats.heapAllocations += ws.heapAllocations;
+        enumerationStats.reportedCliques += ws.reports;
+        enumerationStats.featureShortcuts += ws.featureShortcuts;
+    }
+
+    for (auto& ws : workspaces) {
+        if (ws.forkedSink) sink.join(*ws.forkedSink);
+    }
+    sink.finish();
+}
+
+CliqueHashMap MaximalCliqueHashmap::executeBK(
+    const CSRGraph& graph) {
+
+    CliqueHashMap hashMap;
+    HashmapSink sink(*graph.instances, hashMap);
+    enumerate(graph, sink);
     return hashMap;
 }
 
 std::priority_queue<Colocation, std::vector<Colocation>, ColocationPriorityComp> MaximalCliqueHashmap::extractInitialCandidates(
-    const std::map<Colocation, std::unordered_map<FeatureType, std::set<const SpatialInstance*>>>& hashMap) {
+    const CliqueHashMap& hashMap) {
 
     std::priority_queue<Colocation, std::vector<Colocation>, ColocationPriorityComp> candidateQueue;
     for (const auto& entry : hashMap) {
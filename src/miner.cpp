@@ -4,25 +4,37 @@
  */
 
 #include "miner.h"
+#include "parallel.h"
 #include "utils.h"
 #include <vector>
 #include <queue>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
 
 
 // Main mining algorithm: find all prevalent colocation patterns
 std::set<Colocation> Miner::minePCPs(
 	std::priority_queue<Colocation, std::vector<Colocation>, ColocationPriorityComp>& candidateColocations,
-	const std::map<Colocation, std::unordered_map<FeatureType, std::set<const SpatialInstance*>>>& hashMap,
+	const CliqueHashMap& hashMap,
 	const std::map<FeatureType, int>& featureCounts,
 	double delta,
 	double min_prev) {
 
+	buildIndex(hashMap);
+	weights = buildWeightTable(featureCounts, delta);
+	participation.clear();
+	if (numThreads > 1) return minePCPsByLevel(candidateColocations, min_prev);
+
 	std::set<Colocation> prevalentPCs;
-	std::set<Colocation> nonPrevalentPCs;
-	std::set<Colocation> visited;
+	std::unordered_set<Colocation> nonPrevalentPCs;
+	std::unordered_set<Colocation> visited;
+
+	// Participating instances of evaluated candidates that pushed children, by size.
+	// A child is derived from the parent that pushed it first.
+	std::map<size_t, std::unordered_map<Colocation, std::map<FeatureType, InstanceBitmap>>> instanceCache;
+	std::unordered_map<Colocation, Colocation> parentOf;
 
 	while (!candidateColocations.empty()) {
 		Colocation c = candidateColocations.top();
@@ -31,26 +43,45 @@ std::set<Colocation> Miner::minePCPs(
 		if (visited.count(c)) continue;
 		visited.insert(c);
 
-		std::set<Colocation> newCs;
+		// Parents more than one feature larger have no children left in the queue
+		instanceCache.erase(instanceCache.upper_bound(c.size() + 1), instanceCache.end());
 
-		auto partInstances = queryInstances(c, hashMap);
-		auto rareIntensityMap = calcRareIntensity(c, featureCounts, delta);
+		std::vector<Colocation> newCs;
 
-		double weightedPI = computeWeightedPI(partInstances, c, rareIntensityMap, featureCounts);
+		std::map<FeatureType, InstanceBitmap> partInstances;
+		auto parentIt = parentOf.find(c);
+		if (parentIt != parentOf.end()) {
+			const auto& parentLevel = instanceCache[c.size() + 1];
+			auto cached = parentLevel.find(parentIt->second);
+			partInstances = (cached != parentLevel.end())
+				? queryInstances(c, cached->first, cached->second)
+				: queryInstances(c);
+			parentOf.erase(parentIt);
+		}
+		else {
+			partInstances = queryInstances(c);
+		}
+		double weightedPI = computeWeightedPI(partInstances, c);
 		newCs = generateSubsets(c);
 
 		if (weightedPI >= min_prev) {
 			prevalentPCs.insert(c);
+			if (recordParticipation) participation[c] = participationRatios(partInstances, c);
 
-			auto prevalentSubsets = deducePrevalentSubsets(newCs, c, featureCounts);
+			auto prevalentSubsets = deducePrevalentSubsets(newCs, c);
 			for (const auto& subset : prevalentSubsets) {
 				prevalentPCs.insert(subset);
+				// Exact ratios also need the keys without c's extra feature: one delta query,
+				// only when rules are requested and the subset has no ratios yet
+				if (recordParticipation && !participation.count(subset)) {
+					participation[subset] = participationRatios(queryInstances(subset, c, partInstances), subset);
+				}
 			}
 
-			std::set<Colocation> filteredSubsets;
+			std::vector<Colocation> filteredSubsets;
 			for (const auto& subset : newCs) {
-				if (!prevalentSubsets.count(subset)) {
-					filteredSubsets.insert(subset);
+				if (std::find(prevalentSubsets.begin(), prevalentSubsets.end(), subset) == prevalentSubsets.end()) {
+					filteredSubsets.push_back(subset);
 				}
 			}
 			newCs = filteredSubsets;
@@ -59,42 +90,372 @@ std::set<Colocation> Miner::minePCPs(
 			nonPrevalentPCs.insert(c);
 		}
 
+		bool pushedChildren = false;
 		for (const auto& subset : newCs) {
 			if (!visited.count(subset)) {
 				candidateColocations.push(subset);
+				parentOf.emplace(subset, c);
+				pushedChildren = true;
+			}
+		}
+		if (pushedChildren) instanceCache[c.size()][c] = std::move(partInstances);
+	}
+
+	return prevalentPCs;
+}
+
+// Level-synchronous mining.
+// The queue pops larger candidates first and children are one feature smaller, so the
+// sequential loop handles every size-k candidate before any size-(k-1) one, and the
+// outcome of a candidate depends only on the candidate. Evaluating a whole level at
+// once and merging in a fixed order therefore yields the same pattern set.
+std::set<Colocation> Miner::minePCPsByLevel(
+	std::priority_queue<Colocation, std::vector<Colocation>, ColocationPriorityComp>& candidateColocations,
+	double min_prev) {
+
+	// Candidates grouped by size, each mapped to the position of its first parent in the
+	// previous frontier (kNoParent for initial candidates); the map also drops duplicates.
+	// The previous frontier's instances seed the children.
+	const size_t kNoParent = static_cast<size_t>(-1);
+	std::map<size_t, std::map<Colocation, size_t>> levels;
+	while (!candidateColocations.empty()) {
+		const Colocation& c = candidateColocations.top();
+		levels[c.size()].emplace(c, kNoParent);
+		candidateColocations.pop();
+	}
+
+	std::vector<Colocation> parents;
+	std::vector<std::map<FeatureType, InstanceBitmap>> parentInstances;
+
+	std::set<Colocation> prevalentPCs;
+	while (!levels.empty()) {
+		// Largest remaining size forms the next frontier
+		auto levelIt = std::prev(levels.end());
+		size_t level = levelIt->first;
+		// Children always form the very next frontier, so parents is their parent level
+		std::vector<Colocation> frontier;
+		std::vector<size_t> parentOf;
+		frontier.reserve(levelIt->second.size());
+		parentOf.reserve(levelIt->second.size());
+		for (const auto& entry : levelIt->second) {
+			frontier.push_back(entry.first);
+			parentOf.push_back(entry.second);
+		}
+		levels.erase(levelIt);
+
+		// 1. Evaluate the frontier in parallel
+		std::vector<char> isPrevalent(frontier.size(), 0);
+		std::vector<std::map<FeatureType, InstanceBitmap>> frontierInstances(frontier.size());
+		std::vector<std::vector<double>> frontierRatios(recordParticipation ? frontier.size() : 0);
+		size_t numChunks = std::min<size_t>(frontier.size(), static_cast<size_t>(numThreads) * 8);
+		parallelForChunks(frontier.size(), numChunks, numThreads, [&](size_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				const Colocation& c = frontier[i];
+				frontierInstances[i] = (parentOf[i] != kNoParent)
+					? queryInstances(c, parents[parentOf[i]], parentInstances[parentOf[i]])
+					: queryInstances(c);
+				isPrevalent[i] = computeWeightedPI(frontierInstances[i], c) >= min_prev;
+
+				if (recordParticipation && isPrevalent[i]) {
+					frontierRatios[i] = participationRatios(frontierInstances[i], c);
+				}
+			}
+			});
+
+		// 2. Merge: record patterns, deduce prevalent subsets, collect the next level
+		std::map<Colocation, size_t>& children = levels[level - 1];
+		std::map<Colocation, size_t> deducedBy;  // deduced subset -> first prevalent parent
+		for (size_t i = 0; i < frontier.size(); ++i) {
+			const Colocation& c = frontier[i];
+			std::vector<Colocation> newCs = generateSubsets(c);
+
+			if (isPrevalent[i]) {
+				prevalentPCs.insert(c);
+				if (recordParticipation) participation.emplace(c, std::move(frontierRatios[i]));
+
+				auto prevalentSubsets = deducePrevalentSubsets(newCs, c);
+				for (const auto& subset : prevalentSubsets) {
+					prevalentPCs.insert(subset);
+					if (recordParticipation) deducedBy.emplace(subset, i);
+				}
+				for (const auto& subset : newCs) {
+					if (std::find(prevalentSubsets.begin(), prevalentSubsets.end(), subset) == prevalentSubsets.end()) {
+						children.emplace(subset, i);
+					}
+				}
+			}
+			else {
+				for (const auto& subset : newCs) children.emplace(subset, i);
 			}
 		}
+		if (recordParticipation) recordDeducedRatios(deducedBy, children, frontier, frontierInstances);
+		if (children.empty()) levels.erase(level - 1);
+
+		parents = std::move(frontier);
+		parentInstances = std::move(frontierInstances);
 	}
 
 	return prevalentPCs;
 }
 
 
+// Ratios of subsets deduced prevalent at this level. Exact ratios also need the keys
+// that contain the subset but not its parent, so each distinct subset is derived once
+// from its first parent with a delta query; subsets that another parent pushed to the
+// next level are skipped, since evaluating them there records their ratios anyway.
+void Miner::recordDeducedRatios(
+	const std::map<Colocation, size_t>& deducedBy,
+	const std::map<Colocation, size_t>& nextLevel,
+	const std::vector<Colocation>& frontier,
+	const std::vector<std::map<FeatureType, InstanceBitmap>>& frontierInstances) {
+
+	std::vector<std::pair<Colocation, size_t>> pending;
+	for (const auto& entry : deducedBy) {
+		if (!participation.count(entry.first) && !nextLevel.count(entry.first)) pending.push_back(entry);
+	}
+
+	std::vector<std::vector<double>> ratios(pending.size());
+	size_t numChunks = std::min<size_t>(pending.size(), static_cast<size_t>(numThreads) * 8);
+	parallelForChunks(pending.size(), numChunks, numThreads, [&](size_t, size_t begin, size_t end) {
+		for (size_t j = begin; j < end; ++j) {
+			const Colocation& subset = pending[j].first;
+			size_t parent = pending[j].second;
+			ratios[j] = participationRatios(queryInstances(subset, frontier[parent], frontierInstances[parent]), subset);
+		}
+		});
+
+	for (size_t j = 0; j < pending.size(); ++j) {
+		participation.emplace(std::move(pending[j].first), std::move(ratios[j]));
+	}
+}
+
+// Top-K mining.
+// Same lattice walk as minePCPs, with the prevalence threshold raised to the k-th best
+// weighted PI found so far. Every colocation C' with at least two features satisfies
+//   PI(C') <= PR(f_min', C') <= PR(f_min', {f_min', g})   for any other g in C'
+// (W_log of f_min' is 1), so a candidate whose pairs all stay below the threshold is
+// dropped together with its subsets, and a candidate whose own bound is below it is
+// only expanded, never evaluated.
+std::vector<ScoredColocation> Miner::mineTopK(
+	std::priority_queue<Colocation, std::vector<Colocation>, ColocationPriorityComp>& candidateColocations,
+	const CliqueHashMap& hashMap,
+	const std::map<FeatureType, int>& featureCounts,
+	double delta,
+	double min_prev,
+	size_t k) {
+
+	std::vector<ScoredColocation> result;
+	if (k == 0) return result;
+
+	buildIndex(hashMap);
+	weights = buildWeightTable(featureCounts, delta);
+	participation.clear();
+	std::vector<ScoredColocation> pairs = buildPairRatios();
+
+	// Higher PI first, ties in colocation order; the heap top is the worst kept pattern
+	auto better = [](const ScoredColocation& a, const ScoredColocation& b) {
+		if (a.weightedPI != b.weightedPI) return a.weightedPI > b.weightedPI;
+		return a.pattern < b.pattern;
+	};
+	std::priority_queue<ScoredColocation, std::vector<ScoredColocation>, decltype(better)> best(better);
+	double threshold = min_prev;
+	std::unordered_set<Colocation> scored;
+
+	auto offer = [&](const Colocation& pattern, double weightedPI) {
+		if (weightedPI < threshold || !scored.insert(pattern).second) return;
+		ScoredColocation entry{ pattern, weightedPI };
+		if (best.size() < k) best.push(entry);
+		else if (better(entry, best.top())) {
+			best.pop();
+			best.push(entry);
+		}
+		if (best.size() == k) threshold = std::max(min_prev, best.top().weightedPI);
+	};
+
+	// Size-2 patterns are already scored: they set a high threshold before the walk starts
+	for (const auto& pair : pairs) offer(pair.pattern, pair.weightedPI);
+
+	std::unordered_set<Colocation> visited;
+	std::map<size_t, std::unordered_map<Colocation, std::map<FeatureType, InstanceBitmap>>> instanceCache;
+	std::unordered_map<Colocation, Colocation> parentOf;
+
+	while (!candidateColocations.empty()) {
+		Colocation c = candidateColocations.top();
+		candidateColocations.pop();
+
+		if (visited.count(c) || c.size() <= 2) continue;
+		visited.insert(c);
+
+		instanceCache.erase(instanceCache.upper_bound(c.size() + 1), instanceCache.end());
+
+		auto parentIt = parentOf.find(c);
+		const Colocation* parent = nullptr;
+		const std::map<FeatureType, InstanceBitmap>* cachedParent = nullptr;
+		if (parentIt != parentOf.end()) {
+			const auto& parentLevel = instanceCache[c.size() + 1];
+			auto cached = parentLevel.find(parentIt->second);
+			if (cached != parentLevel.end()) {
+				parent = &cached->first;
+				cachedParent = &cached->second;
+			}
+		}
+
+		// Neither c nor any of its subsets can reach the threshold
+		if (subsetBound(c) < threshold) {
+			if (parentIt != parentOf.end()) parentOf.erase(parentIt);
+			continue;
+		}
+
+		std::vector<Colocation> newCs = generateSubsets(c);
+		std::map<FeatureType, InstanceBitmap> partInstances;
+		bool evaluated = candidateBound(c) >= threshold;
+
+		if (evaluated) {
+			partInstances = cachedParent ? queryInstances(c, *parent, *cachedParent) : queryInstances(c);
+			double weightedPI = computeWeightedPI(partInstances, c);
+
+			if (weightedPI >= threshold) {
+				offer(c, weightedPI);
+				if (recordParticipation) participation[c] = participationRatios(partInstances, c);
+
+				// Deduced subsets score at least PI(c); score them from c's instances
+				auto prevalentSubsets = deducePrevalentSubsets(newCs, c);
+				for (const auto& subset : prevalentSubsets) {
+					if (scored.count(subset)) continue;
+					auto subsetInstances = queryInstances(subset, c, partInstances);
+					offer(subset, computeWeightedPI(subsetInstances, subset));
+					if (recordParticipation) participation[subset] = participationRatios(subsetInstances, subset);
+				}
+
+				std::vector<Colocation> filteredSubsets;
+				for (const auto& subset : newCs) {
+					if (std::find(prevalentSubsets.begin(), prevalentSubsets.end(), subset) == prevalentSubsets.end()) {
+						filteredSubsets.push_back(subset);
+					}
+				}
+				newCs = filteredSubsets;
+			}
+		}
+		if (parentIt != parentOf.end()) parentOf.erase(parentIt);
+
+		bool pushedChildren = false;
+		for (const auto& subset : newCs) {
+			if (!visited.count(subset)) {
+				candidateColocations.push(subset);
+				if (evaluated) parentOf.emplace(subset, c);
+				pushedChildren = true;
+			}
+		}
+		if (evaluated && pushedChildren) instanceCache[c.size()][c] = std::move(partInstances);
+	}
+
+	result.reserve(best.size());
+	while (!best.empty()) {
+		result.push_back(best.top());
+		best.pop();
+	}
+	std::reverse(result.begin(), result.end());
+	return result;
+}
+
+// PR(a) in the size-2 pattern {a, b} for every pair of counted features.
+// Returns the weighted PI of every pair that occurs in some clique.
+std::vector<ScoredColocation> Miner::buildPairRatios() {
+	std::vector<ScoredColocation> pairs;
+	size_t n = weights.numFeatures;
+	pairRatios.assign(n * n, 0.0);
+
+	for (size_t a = 0; a < n; ++a) {
+		if (weights.counts[a] == 0) continue;
+		for (size_t b = a + 1; b < n; ++b) {
+			if (weights.counts[b] == 0) continue;
+			Colocation pair;
+			pair.insert(static_cast<FeatureType>(a));
+			pair.insert(static_cast<FeatureType>(b));
+
+			auto partInstances = queryInstances(pair);
+			if (partInstances.empty()) continue;
+			pairs.push_back({ pair, computeWeightedPI(partInstances, pair) });
+			if (recordParticipation) participation[pair] = participationRatios(partInstances, pair);
+			for (const auto& entry : partInstances) {
+				FeatureType f = entry.first;
+				FeatureType other = (f == a) ? static_cast<FeatureType>(b) : static_cast<FeatureType>(a);
+				pairRatios[f * n + other] = static_cast<double>(entry.second.cardinality()) / weights.counts[f];
+			}
+		}
+	}
+	return pairs;
+}
+
+// PI(c) = min_f PR(f, C) * W_log(f), and PR(f, C) <= PR(f) in {f, g} for every g in c
+double Miner::candidateBound(const Colocation& c) const {
+	FeatureType fMin = 0;
+	int minCount = 0;
+	for (FeatureType f : c) {
+		int count = weights.count(f);
+		if (count > 0 && (minCount == 0 || count < minCount)) {
+			minCount = count;
+			fMin = f;
+		}
+	}
+	if (minCount == 0) return 0.0;
+
+	size_t n = weights.numFeatures;
+	double bound = -1.0;
+	for (FeatureType f : c) {
+		if (weights.count(f) == 0) continue;
+		double pr = 1.0;
+		for (FeatureType g : c) {
+			if (g != f) pr = std::min(pr, g < n ? pairRatios[f * n + g] : 0.0);
+		}
+		double wpr = pr * weights.weight(fMin, f);
+		if (bound < 0 || wpr < bound) bound = wpr;
+	}
+	return (bound < 0) ? 0.0 : bound;
+}
+
+// Any subset C' scores at most PR(f_min') in a pair of C', hence at most the best pair ratio in c
+double Miner::subsetBound(const Colocation& c) const {
+	size_t n = weights.numFeatures;
+	double bound = 0.0;
+	for (FeatureType a : c) {
+		if (a >= n) continue;
+		for (FeatureType b : c) {
+			if (b != a && b < n) bound = std::max(bound, pairRatios[a * n + b]);
+		}
+	}
+	return bound;
+}
+
+// Index the maximal-clique keys of the hashmap
+void Miner::buildIndex(
+	const CliqueHashMap& hashMap) {
+	std::vector<Colocation> keys;
+	keys.reserve(hashMap.size());
+	cliqueInstances.clear();
+	cliqueInstances.reserve(hashMap.size());
+
+	for (const auto& entry : hashMap) {
+		keys.push_back(entry.first);
+		cliqueInstances.push_back(&entry.second);
+	}
+	supersetIndex.build(keys);
+}
+
 // Query instances of a colocation from hashmap
-std::map<FeatureType, std::set<const SpatialInstance*>> Miner::queryInstances(
-	Colocation c,
-	const std::map<Colocation, std::unordered_map<FeatureType, std::set<const SpatialInstance*>>>& hashMap) {
+std::map<FeatureType, InstanceBitmap> Miner::queryInstances(const Colocation& c) {
 		//////// TODO: Implement (10)/////////
 
-	std::map<FeatureType, std::set<const SpatialInstance*>> instancesMap;
+	std::map<FeatureType, InstanceBitmap> instancesMap;
 
-	for (const auto& entry : hashMap) {
-		const Colocation& maximalClique = entry.first;
-		const auto& cliqueInstances = entry.second;
-
-		// Check if c is a subset of maximalClique
-		bool isSubset = std::includes(
-			maximalClique.begin(), maximalClique.end(),
-			c.begin(), c.end()
-		);
-
-		// If c is a subset, merge instances
-		if (isSubset) {
-			for (const auto& f : c) {
-				if (cliqueInstances.count(f)) {
-					const auto& insts = cliqueInstances.at(f);
-					instancesMap[f].insert(insts.begin(), insts.end());
-				}
+	// Only the maximal cliques whose key contains c contribute
+	for (uint32_t pos : supersetIndex.query(c)) {
+		const auto& instancesOfKey = *cliqueInstances[pos];
+
+		for (const auto& f : c) {
+			auto it = instancesOfKey.find(f);
+			if (it != instancesOfKey.end()) {
+				instancesMap[f].unionWith(it->second);
 			}
 		}
 	}
@@ -102,49 +463,79 @@ std::map<FeatureType, std::set<const SpatialInstance*>> Miner::queryInstances(
 	return instancesMap;
 };
 
-// Compute weighted participation index for a colocation
-double Miner::computeWeightedPI(
-	const std::map<FeatureType, std::set<const SpatialInstance*>>& partInstances,
-	Colocation c,
-	const std::unordered_map<FeatureType, double>& rareIntensityMap,
-	const std::map<FeatureType, int>& featureCounts) {
-		//////// TODO: Implement (12)/////////
-	if (c.empty()) return 0.0;
-	
-	double minWPR = -1.0;
+// Query instances of c = parent minus one feature.
+// Every key containing the parent also contains c, so parentInstances already holds
+// their contribution; only supersets of c without the removed feature are added.
+std::map<FeatureType, InstanceBitmap> Miner::queryInstances(
+	const Colocation& c,
+	const Colocation& parent,
+	const std::map<FeatureType, InstanceBitmap>& parentInstances) {
 
+	std::map<FeatureType, InstanceBitmap> instancesMap;
 	for (const auto& f : c) {
-		// Calculate PR = count / N
-		int count = 0;
-		if (partInstances.count(f)) {
-			count = partInstances.at(f).size();
+		auto it = parentInstances.find(f);
+		if (it != parentInstances.end()) instancesMap.emplace(f, it->second);
+	}
+
+	FeatureType removed = 0;
+	for (FeatureType f : parent) {
+		if (!c.contains(f)) {
+			removed = f;
+			break;
 		}
+	}
 
-		int totalCount = 0;
-		if (featureCounts.count(f)) {
-			totalCount = featureCounts.at(f);
+	for (uint32_t pos : supersetIndex.query(c, removed)) {
+		const auto& instancesOfKey = *cliqueInstances[pos];
+
+		for (const auto& f : c) {
+			auto it = instancesOfKey.find(f);
+			if (it != instancesOfKey.end()) {
+				instancesMap[f].unionWith(it->second);
+			}
 		}
+	}
 
-		if (totalCount == 0) continue;
+	return instancesMap;
+};
 
-		double pr = static_cast<double>(count) / totalCount;
+// Compute weighted participation index for a colocation:
+// min over f of PR(f) * W_log(f), with W_log read from the precomputed table
+double Miner::computeWeightedPI(
+	const std::map<FeatureType, InstanceBitmap>& partInstances,
+	const Colocation& c) const {
+		//////// TODO: Implement (12)/////////
+	if (c.empty()) return 0.0;
 
-		// Retrieve RI
-		double ri = 1.0; // Default if missing? Or should skip? 
-		// If RI is missing, it implies error or skip. 
-		// According to logic, RI depends on featureCounts. If >0 count, RI exists.
-		if (rareIntensityMap.count(f)) {
-			ri = rareIntensityMap.at(f);
+	// The rarest counted feature selects the row of the weight table
+	FeatureType fMin = 0;
+	int minCount = 0;
+	for (FeatureType f : c) {
+		int count = weights.count(f);
+		if (count > 0 && (minCount == 0 || count < minCount)) {
+			minCount = count;
+			fMin = f;
 		}
+	}
+	if (minCount == 0) return 0.0;
 
-		// Calculate W_log = 1 / RI
-		double w_log = 0.0;
-		if (ri > 1e-9) {
-			w_log = 1.0 / ri;
+	double minWPR = -1.0;
+
+	// partInstances holds a subset of c's features; both are ascending
+	auto it = partInstances.begin();
+	for (FeatureType f : c) {
+		int totalCount = weights.count(f);
+		if (totalCount == 0) continue;
+
+		while (it != partInstances.end() && it->first < f) ++it;
+		int count = 0;
+		if (it != partInstances.end() && it->first == f) {
+			count = static_cast<int>(it->second.cardinality());
 		}
 
 		// WPR = PR * W_log
-		double wpr = pr * w_log;
+		double pr = static_cast<double>(count) / totalCount;
+		double wpr = pr * weights.weight(fMin, f);
 
 		if (minWPR < 0 || wpr < minWPR) {
 			minWPR = wpr;
@@ -154,37 +545,51 @@ double Miner::computeWeightedPI(
 	return (minWPR < 0) ? 0.0 : minWPR;
 };
 
+// PR(f, C) = participating instances of f / N(f), for every f of c in ascending order
+std::vector<double> Miner::participationRatios(
+	const std::map<FeatureType, InstanceBitmap>& partInstances,
+	const Colocation& c) const {
+	std::vector<double> ratios;
+	ratios.reserve(c.size());
+
+	auto it = partInstances.begin();
+	for (FeatureType f : c) {
+		while (it != partInstances.end() && it->first < f) ++it;
+		size_t count = (it != partInstances.end() && it->first == f) ? it->second.cardinality() : 0;
+		int totalCount = weights.count(f);
+		ratios.push_back(totalCount > 0 ? static_cast<double>(count) / totalCount : 0.0);
+	}
+	return ratios;
+}
+
 // Generate all size-1 subsets (remove one feature at a time)
-std::set<Colocation> Miner::generateSubsets(const Colocation& c) {
-	std::set<Colocation> subsets;
+std::vector<Colocation> Miner::generateSubsets(const Colocation& c) {
+	std::vector<Colocation> subsets;
 	if (c.size() <= 2) return subsets;
 
-	for (size_t i = 0; i < c.size(); ++i) {
+	subsets.reserve(c.size());
+	for (FeatureType f : c) {
 		Colocation sub = c;
-		sub.erase(sub.begin() + i);
-		subsets.insert(sub);
+		sub.erase(f);
+		subsets.push_back(sub);
 	}
 	return subsets;
 };
 
 // Deduce prevalent subsets using downward closure property
-std::set<Colocation> Miner::deducePrevalentSubsets(
-	std::set<Colocation>& subsets,
-	const Colocation& c,
-	const std::map<FeatureType, int>& featureCounts) {
+std::vector<Colocation> Miner::deducePrevalentSubsets(
+	const std::vector<Colocation>& subsets,
+	const Colocation& c) const {
 	
-	std::set<Colocation> provenPrevalent;
+	std::vector<Colocation> provenPrevalent;
 	
 	// 1. Find f_min (feature with min frequency) in parent c
-	FeatureType f_min;
+	FeatureType f_min = 0;
 	int minCount = -1;
 
 	for (const auto& f : c) {
-		int count = 0;
-		if (featureCounts.count(f)) {
-			count = featureCounts.at(f);
-		}
-		
+		int count = weights.count(f);
+
 		if (minCount == -1 || count < minCount) {
 			minCount = count;
 			f_min = f;
@@ -195,18 +600,10 @@ std::set<Colocation> Miner::deducePrevalentSubsets(
 	}
 
 	// 2. Lemma 2: If C is prevalent, any subset C' containing f_min is also prevalent.
-	if (!f_min.empty()) {
+	if (minCount != -1) {
 		for (const auto& subset : subsets) {
-			bool hasMinFeature = false;
-			for (const auto& f : subset) {
-				if (f == f_min) {
-					hasMinFeature = true;
-					break;
-				}
-			}
-
-			if (hasMinFeature) {
-				provenPrevalent.insert(subset);
+			if (subset.contains(f_min)) {
+				provenPrevalent.push_back(subset);
 			}
 		}
 	}
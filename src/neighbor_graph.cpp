@@ -4,90 +4,211 @@
  */
 
 #include "neighbor_graph.h"
+#include "distance_filter.h"
+#include "parallel.h"
 #include <cmath>
 #include <algorithm>
 #include <unordered_map>
+#include <cstdint>
 
-// Calculate Euclidean distance between two spatial instances
-double NeighborGraph::euclideanDist(const SpatialInstance& a, const SpatialInstance& b) {
-	return std::sqrt(std::pow(a.x - b.x, 2) + std::pow(a.y - b.y, 2));
-};
+// Parse a neighbor search method name from the configuration
+NeighborSearchMethod parseNeighborSearchMethod(const std::string& name) {
+	if (name == "grid") return NeighborSearchMethod::Grid;
+	return NeighborSearchMethod::PlaneSweep;
+}
+
+// Number of work chunks for n items: a few per thread to even out dense regions
+size_t NeighborGraph::numChunksFor(size_t n) const {
+	if (numThreads <= 1 || n == 0) return 1;
+	return std::min<size_t>(n, static_cast<size_t>(numThreads) * 8);
+}
 
 // Find all neighbor pairs within distance threshold
-std::vector<std::pair<SpatialInstance, SpatialInstance>> NeighborGraph::findNeighborPair(
-	const std::vector<SpatialInstance>& instances,
+std::vector<NeighborGraph::PairBuffer> NeighborGraph::findNeighborPair(
+	const InstanceTable& instances,
 	double distanceThreshold) {
 	/// using plan sweep
-	std::vector<std::pair<SpatialInstance, SpatialInstance>> pairs;
-
-	// Create a copy to sort by X coordinate for Plane Sweep
-	std::vector<SpatialInstance> sortedInstances = instances;
-	std::sort(sortedInstances.begin(), sortedInstances.end(),
-		[](const SpatialInstance& a, const SpatialInstance& b) {
-			return a.x < b.x;
+	// Sort instance indices by X coordinate for Plane Sweep
+	std::vector<int32_t> order(instances.size());
+	for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int32_t>(i);
+	std::sort(order.begin(), order.end(),
+		[&](int32_t a, int32_t b) {
+			return instances.x[a] < instances.x[b];
 		});
 
+	// Coordinates and features in sweep order, so the inner loop reads them contiguously
+	std::vector<double> xs(order.size()), ys(order.size());
+	std::vector<FeatureType> features(order.size());
+	for (size_t i = 0; i < order.size(); ++i) {
+		xs[i] = instances.x[order[i]];
+		ys[i] = instances.y[order[i]];
+		features[i] = instances.feature[order[i]];
+	}
+
 	// Plane Sweep Algorithm
-	for (size_t i = 0; i < sortedInstances.size(); ++i) {
-		for (size_t j = i + 1; j < sortedInstances.size(); ++j) {
-			// Optimization: Break if X distance exceeds threshold
-			if (sortedInstances[j].x - sortedInstances[i].x > distanceThreshold) {
-				break;
-			}
+	// Each chunk of sweep rows fills its own buffer; buffers are kept in chunk order
+	size_t numChunks = numChunksFor(order.size());
+	std::vector<PairBuffer> buffers(numChunks);
+	distfilter::Points points{ xs.data(), ys.data(), features.data() };
 
-			// Check Y distance
-			if (std::abs(sortedInstances[j].y - sortedInstances[i].y) <= distanceThreshold) {
-				// Check exact Euclidean distance
-				if (euclideanDist(sortedInstances[i], sortedInstances[j]) <= distanceThreshold &&
-					sortedInstances[i].type != sortedInstances[j].type) {
-					pairs.push_back({ sortedInstances[i], sortedInstances[j] });
-				}
+	parallelForChunks(order.size(), numChunks, numThreads, [&](size_t chunk, size_t begin, size_t end) {
+		auto& local = buffers[chunk];
+		std::vector<int32_t> hits;
+		for (size_t i = begin; i < end; ++i) {
+			// Window of row i: candidates until the X gap exceeds the threshold
+			size_t windowEnd = std::partition_point(xs.begin() + i + 1, xs.end(),
+				[&](double x) { return x - xs[i] <= distanceThreshold; }) - xs.begin();
+			if (hits.size() < windowEnd - i) hits.resize(windowEnd - i);
+
+			size_t numHits = distfilter::filter(points, i, i + 1, windowEnd, distanceThreshold, hits.data());
+			for (size_t k = 0; k < numHits; ++k) {
+				local.push_back({ order[i], order[hits[k]] });
 			}
 		}
-	}
-	return pairs;
+		});
+
+	return buffers;
 };
 
-// Build neighbor graph: create NeighborSet for each instance
-std::vector<NeighborSet> NeighborGraph::buildNeighborGraph(
-	const std::vector<SpatialInstance>& instances,
+// Find all neighbor pairs within distance threshold using a uniform grid
+std::vector<NeighborGraph::PairBuffer> NeighborGraph::findNeighborPairGrid(
+	const InstanceTable& instances,
 	double distanceThreshold) {
-		//////// TODO: Implement (3)//////////
+	// Degenerate cell size: fall back to the sweep
+	if (instances.empty() || !(distanceThreshold > 0.0)) {
+		return findNeighborPair(instances, distanceThreshold);
+	}
 
-	// 1. Find all neighbor pairs
-	auto pairs = findNeighborPair(instances, distanceThreshold);
+	double minX = *std::min_element(instances.x.begin(), instances.x.end());
+	double minY = *std::min_element(instances.y.begin(), instances.y.end());
 
-	// 2. Map InstanceID to memory address for stable graph construction
-	std::unordered_map<InstanceID, const SpatialInstance*> ptrMap;
+	// 1. Assign every instance to a cell of size distanceThreshold
+	//    Cell key packs (cx, cy) into 64 bits: cx in the high half, cy in the low half
+	auto cellKey = [](uint64_t cx, uint64_t cy) { return (cx << 32) | cy; };
+
+	std::vector<std::pair<uint64_t, int32_t>> cellOf;
+	cellOf.reserve(instances.size());
 	for (size_t i = 0; i < instances.size(); ++i) {
-		ptrMap[instances[i].id] = &instances[i];
+		uint64_t cx = static_cast<uint64_t>(std::floor((instances.x[i] - minX) / distanceThreshold));
+		uint64_t cy = static_cast<uint64_t>(std::floor((instances.y[i] - minY) / distanceThreshold));
+		cellOf.push_back({ cellKey(cx, cy), static_cast<int32_t>(i) });
+	}
+	std::sort(cellOf.begin(), cellOf.end());
+
+	// Coordinates and features in cell order: a cell is a contiguous run of these arrays
+	std::vector<double> xs(cellOf.size()), ys(cellOf.size());
+	std::vector<FeatureType> features(cellOf.size());
+	for (size_t i = 0; i < cellOf.size(); ++i) {
+		xs[i] = instances.x[cellOf[i].second];
+		ys[i] = instances.y[cellOf[i].second];
+		features[i] = instances.feature[cellOf[i].second];
 	}
 
-	// 3. Build Adjacency List
-	std::unordered_map<const SpatialInstance*, std::vector<const SpatialInstance*>> adjList;
-	// Initialize for all instances
-	for (const auto& inst : instances) {
-		adjList[&inst] = std::vector<const SpatialInstance*>();
+	// 2. Bucket boundaries: cell key -> [begin, end) range in cellOf
+	//    cellList keeps the cells in key order so work can be split deterministically
+	std::vector<uint64_t> cellList;
+	std::unordered_map<uint64_t, std::pair<size_t, size_t>> buckets;
+	for (size_t b = 0; b < cellOf.size();) {
+		size_t e = b;
+		while (e < cellOf.size() && cellOf[e].first == cellOf[b].first) ++e;
+		buckets[cellOf[b].first] = { b, e };
+		cellList.push_back(cellOf[b].first);
+		b = e;
 	}
 
-	for (const auto& p : pairs) {
-		const SpatialInstance* p1 = ptrMap[p.first.id];
-		const SpatialInstance* p2 = ptrMap[p.second.id];
-		if (p1 && p2) {
-			adjList[p1].push_back(p2);
-			adjList[p2].push_back(p1);
+	// Neighbors of position i among positions [candBegin, candEnd), appended to local
+	distfilter::Points points{ xs.data(), ys.data(), features.data() };
+	auto addNeighbors = [&](PairBuffer& local, std::vector<int32_t>& hits, size_t i, size_t candBegin, size_t candEnd) {
+		if (hits.size() < candEnd - candBegin) hits.resize(candEnd - candBegin);
+		size_t numHits = distfilter::filter(points, i, candBegin, candEnd, distanceThreshold, hits.data());
+		for (size_t k = 0; k < numHits; ++k) {
+			local.push_back({ cellOf[i].second, cellOf[hits[k]].second });
+		}
+		};
+
+	// 3. Scan each cell against itself and its forward half of the 3x3 block,
+	//    so every unordered pair of cells is visited exactly once
+	//    Each chunk of cells fills its own buffer; buffers are kept in chunk order
+	const int forwardCells[4][2] = { { 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 } };
+	size_t numChunks = numChunksFor(cellList.size());
+	std::vector<PairBuffer> buffers(numChunks);
+
+	parallelForChunks(cellList.size(), numChunks, numThreads, [&](size_t chunk, size_t cellBegin, size_t cellEnd) {
+		auto& local = buffers[chunk];
+		std::vector<int32_t> hits;
+		for (size_t c = cellBegin; c < cellEnd; ++c) {
+			uint64_t cx = cellList[c] >> 32;
+			uint64_t cy = cellList[c] & 0xFFFFFFFFull;
+			const auto& bucket = buckets.at(cellList[c]);
+			size_t begin = bucket.first;
+			size_t end = bucket.second;
+
+			// Pairs inside the cell
+			for (size_t i = begin; i < end; ++i) {
+				addNeighbors(local, hits, i, i + 1, end);
+			}
+
+			// Pairs with the adjacent cells
+			for (const auto& offset : forwardCells) {
+				if (offset[1] < 0 && cy == 0) continue;
+				auto it = buckets.find(cellKey(cx + offset[0], cy + offset[1]));
+				if (it == buckets.end()) continue;
+
+				for (size_t i = begin; i < end; ++i) {
+					addNeighbors(local, hits, i, it->second.first, it->second.second);
+				}
+			}
+		}
+		});
+
+	return buffers;
+};
+
+// Build neighbor graph: CSR rows built in two passes over the pair buffers
+CSRGraph NeighborGraph::buildNeighborGraph(
+	const InstanceTable& instances,
+	double distanceThreshold,
+	NeighborSearchMethod method) {
+		//////// TODO: Implement (3)//////////
+
+	// 1. Find all neighbor pairs
+	auto buffers = (method == NeighborSearchMethod::Grid)
+		? findNeighborPairGrid(instances, distanceThreshold)
+		: findNeighborPair(instances, distanceThreshold);
+
+	CSRGraph graph;
+	graph.instances = &instances;
+	graph.offsets.assign(instances.size() + 1, 0);
+
+	// 2. Pass 1: count degrees, then prefix-sum into row offsets
+	for (const auto& buffer : buffers) {
+		for (const auto& p : buffer) {
+			graph.offsets[p.first + 1]++;
+			graph.offsets[p.second + 1]++;
 		}
 	}
+	for (size_t u = 0; u < instances.size(); ++u) {
+		graph.offsets[u + 1] += graph.offsets[u];
+	}
 
-	// 4. Construct NeighborSets
-	std::vector<NeighborSet> neighborSets;
-	neighborSets.reserve(instances.size());
-	for (const auto& inst : instances) {
-		NeighborSet ns;
-		ns.center = &inst;
-		ns.neighbors = adjList[&inst];
-		neighborSets.push_back(ns);
+	// 3. Pass 2: scatter both directions of every pair into its row
+	graph.neighbors.resize(graph.offsets.back());
+	std::vector<size_t> cursor(graph.offsets.begin(), graph.offsets.end() - 1);
+	for (auto& buffer : buffers) {
+		for (const auto& p : buffer) {
+			graph.neighbors[cursor[p.first]++] = p.second;
+			graph.neighbors[cursor[p.second]++] = p.first;
+		}
+		PairBuffer().swap(buffer);
 	}
 
-	return neighborSets;
+	// 4. Sort every row so the result does not depend on the pair order
+	//    produced by the search method
+	parallelForChunks(instances.size(), numChunksFor(instances.size()), numThreads, [&](size_t, size_t begin, size_t end) {
+		for (size_t u = begin; u < end; ++u) {
+			std::sort(graph.neighbors.begin() + graph.offsets[u], graph.neighbors.begin() + graph.offsets[u + 1]);
+		}
+		});
+
+	return graph;
 };
@@ -0,0 +1,58 @@
+/**
+ * @file rule_generator.cpp
+ * @brief Implementation: Colocation rules from participation ratios
+ */
+
+#include "rule_generator.h"
+#include "parallel.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+	// Rules of one pattern: {f} -> C \ {f} for every feature f with PR(f, C) >= minCondProb.
+	// The share of f's instances that take part in a row instance of C is exactly the
+	// conditional probability of the rule.
+	void rulesOfPattern(
+		const Colocation& c,
+		const std::vector<double>& ratios,
+		double minCondProb,
+		std::vector<ColocationRule>& out) {
+
+		if (c.size() < 2) return;
+		size_t i = 0;
+		for (FeatureType f : c) {
+			double ratio = ratios[i++];
+			if (ratio < minCondProb) continue;
+
+			ColocationRule rule{ Colocation(), c, ratio };
+			rule.antecedent.insert(f);
+			rule.consequent.erase(f);
+			out.push_back(rule);
+		}
+	}
+}
+
+// Generate rules for every pattern, chunks of patterns in parallel
+std::vector<ColocationRule> RuleGenerator::generate(
+	const std::vector<Colocation>& patterns,
+	const ParticipationMap& participation,
+	double minCondProb) const {
+
+	// One buffer per chunk, concatenated in chunk order: same output for any thread count
+	size_t numChunks = std::min<size_t>(patterns.size(), static_cast<size_t>(numThreads) * 8);
+	std::vector<std::vector<ColocationRule>> buffers(numChunks);
+	parallelForChunks(patterns.size(), numChunks, numThreads, [&](size_t chunk, size_t begin, size_t end) {
+		for (size_t p = begin; p < end; ++p) {
+			auto it = participation.find(patterns[p]);
+			if (it == participation.end()) continue;
+			rulesOfPattern(patterns[p], it->second, minCondProb, buffers[chunk]);
+		}
+		});
+
+	std::vector<ColocationRule> rules;
+	for (auto& buffer : buffers) {
+		rules.insert(rules.end(), std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()));
+	}
+	return rules;
+}
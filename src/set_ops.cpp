@@ -0,0 +1,287 @@
+/**
+ * @file set_ops.cpp
+ * @brief Implementation: Sorted-set intersection kernels with runtime dispatch
+ */
+
+#include "set_ops.h"
+#include "bit_ops.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SETOPS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC / Clang compile the SIMD kernels for their target ISA only; MSVC needs no attribute.
+// SETOPS_KERNEL also flattens the kernel entry so the block compare is inlined into the
+// merge loop (GCC does not inline across differing target attributes on its own).
+#if defined(SETOPS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SETOPS_TARGET(isa) __attribute__((target(isa)))
+#define SETOPS_KERNEL(isa) __attribute__((target(isa), flatten))
+#else
+#define SETOPS_TARGET(isa)
+#define SETOPS_KERNEL(isa)
+#endif
+
+namespace setops {
+
+	namespace {
+
+		// Longer list at least this many times the shorter one: gallop instead of merging
+		constexpr size_t kGallopRatio = 32;
+
+		// Shorter list below this size: plain scalar merge, no dispatch
+		constexpr size_t kBlockMin = 8;
+
+		// First position in [first, last) with value >= v, probing 1, 2, 4, ... ahead
+		const int32_t* gallop(const int32_t* first, const int32_t* last, int32_t v) {
+			size_t step = 1;
+			const int32_t* lo = first;
+			const int32_t* hi = first;
+			while (hi < last && *hi < v) {
+				lo = hi + 1;
+				hi = (static_cast<size_t>(last - hi) > step) ? hi + step : last;
+				step <<= 1;
+			}
+			return std::lower_bound(lo, hi, v);
+		}
+
+		// What the merge does with each element of A
+		enum class Emit { Count, Matched, Unmatched };
+
+		// Galloping pass: each element of A is searched in B (|A| << |B|)
+		template <Emit mode>
+		size_t gallopScan(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out) {
+			size_t n = 0;
+			const int32_t* it = b;
+			const int32_t* end = b + nb;
+			for (size_t i = 0; i < na; ++i) {
+				it = gallop(it, end, a[i]);
+				bool found = it != end && *it == a[i];
+				if (mode == Emit::Count) n += found;
+				else if (found == (mode == Emit::Matched)) out[n++] = a[i];
+			}
+			return n;
+		}
+
+		// Scalar two-pointer merge
+		template <Emit mode>
+		size_t scalarMerge(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out) {
+			size_t n = 0, i = 0, j = 0;
+			while (i < na && j < nb) {
+				if (a[i] < b[j]) {
+					if (mode == Emit::Unmatched) out[n++] = a[i];
+					++i;
+				}
+				else if (b[j] < a[i]) ++j;
+				else {
+					if (mode == Emit::Count) ++n;
+					else if (mode == Emit::Matched) out[n++] = a[i];
+					++i; ++j;
+				}
+			}
+			if (mode == Emit::Unmatched) {
+				for (; i < na; ++i) out[n++] = a[i];
+			}
+			return n;
+		}
+
+		// Emit one A block from the mask of lanes found in B
+		template <Emit mode>
+		inline size_t emitBlock(const int32_t* block, unsigned matched, unsigned laneMask, int32_t* out) {
+			if (mode == Emit::Count) return static_cast<size_t>(bits::popcount(matched));
+			unsigned keep = (mode == Emit::Matched) ? matched : (~matched & laneMask);
+			size_t n = 0;
+			while (keep) {
+				out[n++] = block[bits::lowestBit(keep)];
+				keep &= keep - 1;
+			}
+			return n;
+		}
+
+		// Blocked merge: W x W all-pairs compares (match(a, b) returns the A lanes found
+		// in the B block). Lanes matched by any B block overlapping the current A block are
+		// accumulated, and the block is emitted when A advances. The tail is merged in
+		// scalar code, reusing the mask of the partially compared A block.
+		template <Emit mode, size_t W, typename Match>
+		size_t blockMerge(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out, Match match) {
+			const unsigned laneMask = (1u << W) - 1;
+			size_t n = 0, i = 0, j = 0;
+			unsigned matched = 0;
+			while (i + W <= na && j + W <= nb) {
+				matched |= match(a + i, b + j);
+				int32_t aMax = a[i + W - 1];
+				int32_t bMax = b[j + W - 1];
+				if (aMax <= bMax) {
+					n += emitBlock<mode>(a + i, matched, laneMask, out ? out + n : nullptr);
+					matched = 0;
+					i += W;
+				}
+				if (bMax <= aMax) j += W;
+			}
+
+			// Tail: the A block at i may already have lanes matched by earlier B blocks
+			if (matched) {
+				for (size_t k = 0; k < W; ++k, ++i) {
+					bool found = (matched >> k) & 1u;
+					while (!found && j < nb && b[j] < a[i]) ++j;
+					if (!found && j < nb && b[j] == a[i]) found = true;
+					if (mode == Emit::Count) n += found;
+					else if (found == (mode == Emit::Matched)) out[n++] = a[i];
+				}
+			}
+			return n + scalarMerge<mode>(a + i, na - i, b + j, nb - j, out ? out + n : nullptr);
+		}
+
+		// --- Scalar kernel ---
+		template <Emit mode>
+		size_t runScalar(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out) {
+			return scalarMerge<mode>(a, na, b, nb, out);
+		}
+
+#ifdef SETOPS_X86
+		// --- SSE4.2 kernel: 4 x 4 compares via 3 lane rotations of the B block ---
+		SETOPS_TARGET("sse4.2")
+		unsigned matchSse(const int32_t* a, const int32_t* b) {
+			__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+			__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+			__m128i eq = _mm_cmpeq_epi32(va, vb);
+			eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+			eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+			eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+			return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+		}
+
+		template <Emit mode>
+		SETOPS_KERNEL("sse4.2")
+		size_t runSse(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out) {
+			return blockMerge<mode, 4>(a, na, b, nb, out, matchSse);
+		}
+
+		// --- AVX2 kernel: 8 x 8 compares via 7 lane rotations of the B block ---
+		SETOPS_TARGET("avx2")
+		unsigned matchAvx2(const int32_t* a, const int32_t* b) {
+			__m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+			__m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+			const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+			__m256i eq = _mm256_cmpeq_epi32(va, vb);
+			for (int r = 1; r < 8; ++r) {
+				vb = _mm256_permutevar8x32_epi32(vb, rotate);
+				eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+			}
+			return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+		}
+
+		template <Emit mode>
+		SETOPS_KERNEL("avx2")
+		size_t runAvx2(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out) {
+			return blockMerge<mode, 8>(a, na, b, nb, out, matchAvx2);
+		}
+
+		bool cpuSupports(Kernel kernel) {
+			if (kernel == Kernel::Scalar) return true;
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			int maxLeaf = info[0];
+			if (maxLeaf < 1) return false;
+			__cpuidex(info, 1, 0);
+			bool sse42 = (info[2] & (1 << 20)) != 0;
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			if (kernel == Kernel::SSE42) return sse42;
+			if (maxLeaf < 7 || !osxsave) return false;
+			bool ymmEnabled = (_xgetbv(0) & 0x6) == 0x6;
+			__cpuidex(info, 7, 0);
+			return ymmEnabled && (info[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			if (kernel == Kernel::SSE42) return __builtin_cpu_supports("sse4.2");
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+#else
+		bool cpuSupports(Kernel kernel) { return kernel == Kernel::Scalar; }
+#endif
+
+		using KernelFn = size_t(*)(const int32_t*, size_t, const int32_t*, size_t, int32_t*);
+
+		/** @brief Function pointers of one kernel, one per operation */
+		struct Dispatch {
+			Kernel kernel;
+			KernelFn count;
+			KernelFn matched;
+			KernelFn unmatched;
+		};
+
+		Dispatch makeDispatch(Kernel kernel) {
+#ifdef SETOPS_X86
+			if (kernel == Kernel::AVX2) {
+				return { kernel, runAvx2<Emit::Count>, runAvx2<Emit::Matched>, runAvx2<Emit::Unmatched> };
+			}
+			if (kernel == Kernel::SSE42) {
+				return { kernel, runSse<Emit::Count>, runSse<Emit::Matched>, runSse<Emit::Unmatched> };
+			}
+#endif
+			return { Kernel::Scalar, runScalar<Emit::Count>, runScalar<Emit::Matched>, runScalar<Emit::Unmatched> };
+		}
+
+		Dispatch& dispatch() {
+			static Dispatch d = makeDispatch(detectKernel());
+			return d;
+		}
+	}
+
+	Kernel detectKernel() {
+		if (cpuSupports(Kernel::AVX2)) return Kernel::AVX2;
+		if (cpuSupports(Kernel::SSE42)) return Kernel::SSE42;
+		return Kernel::Scalar;
+	}
+
+	Kernel activeKernel() {
+		return dispatch().kernel;
+	}
+
+	bool setKernel(Kernel kernel) {
+		if (!cpuSupports(kernel)) return false;
+		dispatch() = makeDispatch(kernel);
+		return true;
+	}
+
+	const char* kernelName(Kernel kernel) {
+		switch (kernel) {
+		case Kernel::AVX2: return "avx2";
+		case Kernel::SSE42: return "sse4.2";
+		default: return "scalar";
+		}
+	}
+
+	size_t intersectCount(const int32_t* a, size_t na, const int32_t* b, size_t nb) {
+		if (na == 0 || nb == 0) return 0;
+		if (na * kGallopRatio < nb) return gallopScan<Emit::Count>(a, na, b, nb, nullptr);
+		if (nb * kGallopRatio < na) return gallopScan<Emit::Count>(b, nb, a, na, nullptr);
+		if (na < kBlockMin || nb < kBlockMin) return scalarMerge<Emit::Count>(a, na, b, nb, nullptr);
+		return dispatch().count(a, na, b, nb, nullptr);
+	}
+
+	size_t intersect(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out) {
+		if (na == 0 || nb == 0) return 0;
+		if (na * kGallopRatio < nb) return gallopScan<Emit::Matched>(a, na, b, nb, out);
+		if (nb * kGallopRatio < na) return gallopScan<Emit::Matched>(b, nb, a, na, out);
+		if (na < kBlockMin || nb < kBlockMin) return scalarMerge<Emit::Matched>(a, na, b, nb, out);
+		return dispatch().matched(a, na, b, nb, out);
+	}
+
+	size_t difference(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out) {
+		if (nb == 0 || na == 0) {
+			std::copy(a, a + na, out);
+			return na;
+		}
+		if (na * kGallopRatio < nb) return gallopScan<Emit::Unmatched>(a, na, b, nb, out);
+		if (na < kBlockMin || nb < kBlockMin) return scalarMerge<Emit::Unmatched>(a, na, b, nb, out);
+		return dispatch().unmatched(a, na, b, nb, out);
+	}
+
+} // namespace setops
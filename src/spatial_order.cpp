@@ -0,0 +1,111 @@
+/**
+ * @file spatial_order.cpp
+ * @brief Implementation: Morton / Hilbert renumbering of instances
+ */
+
+#include "spatial_order.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+	// Spread the 32 bits of v to the even bit positions of a 64-bit word
+	uint64_t spreadBits(uint32_t v) {
+		uint64_t x = v;
+		x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+		x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+		x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+		x = (x | (x << 2)) & 0x3333333333333333ull;
+		x = (x | (x << 1)) & 0x5555555555555555ull;
+		return x;
+	}
+
+	uint64_t mortonKey(uint32_t x, uint32_t y) {
+		return spreadBits(x) | (spreadBits(y) << 1);
+	}
+
+	// Distance along the Hilbert curve of a 2^32 x 2^32 grid
+	uint64_t hilbertKey(uint32_t x, uint32_t y) {
+		uint64_t d = 0;
+		for (uint32_t s = 1u << 31; s > 0; s >>= 1) {
+			uint32_t rx = (x & s) ? 1 : 0;
+			uint32_t ry = (y & s) ? 1 : 0;
+			d += uint64_t(s) * uint64_t(s) * ((3 * rx) ^ ry);
+			// Rotate the quadrant so the sub-curve starts where the parent curve enters
+			if (ry == 0) {
+				if (rx == 1) {
+					x = ~x;
+					y = ~y;
+				}
+				std::swap(x, y);
+			}
+		}
+		return d;
+	}
+
+	// Scale v from [lo, lo + range] to [0, 2^32 - 1]
+	uint32_t quantize(double v, double lo, double range) {
+		if (!(range > 0.0)) return 0;
+		double t = std::floor((v - lo) / range * 4294967295.0);
+		return static_cast<uint32_t>(std::min(std::max(t, 0.0), 4294967295.0));
+	}
+}
+
+// Parse a reorder method name from the configuration
+ReorderMethod parseReorderMethod(const std::string& name) {
+	if (name == "morton") return ReorderMethod::Morton;
+	if (name == "hilbert") return ReorderMethod::Hilbert;
+	return ReorderMethod::None;
+}
+
+// Curve order of the instances: sort (key, id) pairs
+std::vector<InstanceID> spatialOrder(const InstanceTable& instances, ReorderMethod method) {
+	size_t n = instances.size();
+	std::vector<InstanceID> order(n);
+	for (size_t i = 0; i < n; ++i) order[i] = static_cast<InstanceID>(i);
+	if (method == ReorderMethod::None || n == 0) return order;
+
+	auto xRange = std::minmax_element(instances.x.begin(), instances.x.end());
+	auto yRange = std::minmax_element(instances.y.begin(), instances.y.end());
+	double minX = *xRange.first, minY = *yRange.first;
+	double spanX = *xRange.second - minX, spanY = *yRange.second - minY;
+
+	std::vector<std::pair<uint64_t, InstanceID>> keyed(n);
+	for (size_t i = 0; i < n; ++i) {
+		uint32_t qx = quantize(instances.x[i], minX, spanX);
+		uint32_t qy = quantize(instances.y[i], minY, spanY);
+		uint64_t key = (method == ReorderMethod::Hilbert) ? hilbertKey(qx, qy) : mortonKey(qx, qy);
+		keyed[i] = { key, static_cast<InstanceID>(i) };
+	}
+	std::sort(keyed.begin(), keyed.end());
+
+	for (size_t k = 0; k < n; ++k) order[k] = keyed[k].second;
+	return order;
+}
+
+// Permute the table columns and the instance numbers together
+void applyOrder(SpatialDataset& dataset, const std::vector<InstanceID>& order) {
+	const InstanceTable& old = dataset.instances;
+	const std::vector<int>& oldNumbers = dataset.dictionary.instanceNumbers;
+
+	// The permuted table owns its columns, even when the old one viewed a mapped file
+	InstanceTable reordered;
+	reordered.resize(order.size());
+	double* xs = reordered.x.mutableData();
+	double* ys = reordered.y.mutableData();
+	FeatureType* features = reordered.feature.mutableData();
+	InstanceID* ids = reordered.id.mutableData();
+	std::vector<int> numbers(oldNumbers.empty() ? 0 : order.size());
+	for (size_t k = 0; k < order.size(); ++k) {
+		InstanceID from = order[k];
+		xs[k] = old.x[from];
+		ys[k] = old.y[from];
+		features[k] = old.feature[from];
+		ids[k] = static_cast<InstanceID>(k);
+		if (!numbers.empty()) numbers[k] = oldNumbers[old.id[from]];
+	}
+
+	dataset.instances = std::move(reordered);
+	dataset.dictionary.instanceNumbers = std::move(numbers);
+}
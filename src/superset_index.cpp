@@ -0,0 +1,91 @@
+/**
+ * @file superset_index.cpp
+ * @brief Implementation: Inverted feature index over colocation keys
+ */
+
+#include "superset_index.h"
+#include <algorithm>
+
+// Build posting lists: ascending key positions per feature and per feature pair
+void SupersetIndex::build(const std::vector<Colocation>& newKeys) {
+	keys = newKeys;
+	postings.assign(Colocation::kCapacity, std::vector<uint32_t>());
+	pairPostings.clear();
+
+	std::vector<FeatureType> features;
+	for (uint32_t pos = 0; pos < keys.size(); ++pos) {
+		features.assign(keys[pos].begin(), keys[pos].end());
+		for (size_t i = 0; i < features.size(); ++i) {
+			postings[features[i]].push_back(pos);
+			for (size_t j = i + 1; j < features.size(); ++j) {
+				pairPostings[pairKey(features[i], features[j])].push_back(pos);
+			}
+		}
+	}
+}
+
+// Pick the most selective posting list: single features, then feature pairs
+const std::vector<uint32_t>& SupersetIndex::shortestPosting(const Colocation& c) const {
+	static const std::vector<uint32_t> emptyList;
+
+	std::vector<FeatureType> features(c.begin(), c.end());
+	const std::vector<uint32_t>* shortest = &postings[features[0]];
+	for (FeatureType f : features) {
+		if (postings[f].size() < shortest->size()) shortest = &postings[f];
+	}
+	for (size_t i = 0; i < features.size() && !shortest->empty(); ++i) {
+		for (size_t j = i + 1; j < features.size(); ++j) {
+			auto it = pairPostings.find(pairKey(features[i], features[j]));
+			const std::vector<uint32_t>& list = (it != pairPostings.end()) ? it->second : emptyList;
+			if (list.size() < shortest->size()) shortest = &list;
+		}
+	}
+	return *shortest;
+}
+
+// Walk the most selective posting list of c and filter it with subset tests
+std::vector<uint32_t> SupersetIndex::query(const Colocation& c) const {
+	std::vector<uint32_t> result;
+
+	// Empty pattern: every key is a superset
+	if (c.empty()) {
+		result.reserve(keys.size());
+		for (uint32_t pos = 0; pos < keys.size(); ++pos) result.push_back(pos);
+		return result;
+	}
+
+	// Keep the keys from the shortest list that also contain the other features
+	for (uint32_t pos : shortestPosting(c)) {
+		if (c.isSubsetOf(keys[pos])) {
+			result.push_back(pos);
+		}
+	}
+	return result;
+}
+
+// Same walk, minus the positions posted under excluded (both lists are ascending)
+std::vector<uint32_t> SupersetIndex::query(const Colocation& c, FeatureType excluded) const {
+	const std::vector<uint32_t>& skip = postings[excluded];
+	std::vector<uint32_t> result;
+
+	// Empty pattern: every key without the excluded feature
+	if (c.empty()) {
+		auto next = skip.begin();
+		for (uint32_t pos = 0; pos < keys.size(); ++pos) {
+			if (next != skip.end() && *next == pos) ++next;
+			else result.push_back(pos);
+		}
+		return result;
+	}
+
+	auto next = skip.begin();
+	for (uint32_t pos : shortestPosting(c)) {
+		// Gallop: the excluded list can be much longer than the walked one
+		next = std::lower_bound(next, skip.end(), pos);
+		if (next != skip.end() && *next == pos) continue;
+		if (c.isSubsetOf(keys[pos])) {
+			result.push_back(pos);
+		}
+	}
+	return result;
+}
@@ -0,0 +1,402 @@
+/**
+ * @file tiled_executor.cpp
+ * @brief Implementation: Tiled out-of-core processing
+ */
+
+#include "tiled_executor.h"
+#include "clique_sink.h"
+#include "data_loader.h"
+#include "maximal_clique_hashmap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+	/** @brief Tile grid over the dataset bounding box */
+	struct TileGrid {
+		double minX = 0.0, minY = 0.0;
+		double size = 1.0;
+		int tilesX = 1, tilesY = 1;
+
+		int column(double x) const { return clampColumn(static_cast<int>(std::floor((x - minX) / size))); }
+		int row(double y) const { return clampRow(static_cast<int>(std::floor((y - minY) / size))); }
+		int clampColumn(int c) const { return std::min(std::max(c, 0), tilesX - 1); }
+		int clampRow(int r) const { return std::min(std::max(r, 0), tilesY - 1); }
+		int index(int c, int r) const { return r * tilesX + c; }
+	};
+
+	// Rows buffered over all tiles in pass 2; past it the largest buckets go to their files
+	constexpr size_t kBufferedRowsBudget = 1 << 16;
+
+	// Result files merged at once; more are merged in several passes
+	constexpr size_t kMergeFanIn = 64;
+
+	std::string bucketPath(const std::string& dir, int tile) {
+		return (fs::path(dir) / ("tile_" + std::to_string(tile) + ".bucket")).string();
+	}
+
+	std::string resultPath(const std::string& dir, int tile) {
+		return (fs::path(dir) / ("tile_" + std::to_string(tile) + ".cliques")).string();
+	}
+
+	std::string mergePath(const std::string& dir, size_t run) {
+		return (fs::path(dir) / ("merge_" + std::to_string(run) + ".cliques")).string();
+	}
+
+	void appendRows(const std::string& path, std::vector<SpatialInstance>& rows) {
+		if (rows.empty()) return;
+		std::ofstream out(path, std::ios::binary | std::ios::app);
+		if (!out.is_open()) throw std::runtime_error("Cannot write tile bucket " + path);
+		out.write(reinterpret_cast<const char*>(rows.data()), static_cast<std::streamsize>(rows.size() * sizeof(SpatialInstance)));
+		std::vector<SpatialInstance>().swap(rows);  // Give the capacity back too
+	}
+
+	std::vector<SpatialInstance> readRows(const std::string& path) {
+		std::vector<SpatialInstance> rows;
+		std::ifstream in(path, std::ios::binary | std::ios::ate);
+		if (!in.is_open()) return rows;
+		std::streamsize bytes = in.tellg();
+		in.seekg(0);
+		rows.resize(static_cast<size_t>(bytes) / sizeof(SpatialInstance));
+		in.read(reinterpret_cast<char*>(rows.data()), static_cast<std::streamsize>(rows.size() * sizeof(SpatialInstance)));
+		return rows;
+	}
+
+	/** @brief One key of a result file with the sorted instance ids of each feature */
+	struct ResultRecord {
+		Colocation key;
+		std::vector<std::pair<FeatureType, std::vector<uint32_t>>> features;  ///< Sorted by feature
+	};
+
+	// Result file: records in ascending key order; per record: Words x uint64 key,
+	// uint32 numFeatures, then per feature: uint16 feature, uint32 numIds, numIds x uint32 ids
+	void writeRecord(std::ofstream& out, const ResultRecord& record) {
+		constexpr size_t kWords = Colocation::kCapacity / 64;
+		for (size_t w = 0; w < kWords; ++w) {
+			uint64_t word = record.key.word(w);
+			out.write(reinterpret_cast<const char*>(&word), sizeof(word));
+		}
+		uint32_t numFeatures = static_cast<uint32_t>(record.features.size());
+		out.write(reinterpret_cast<const char*>(&numFeatures), sizeof(numFeatures));
+		for (const auto& featureIds : record.features) {
+			uint16_t feature = featureIds.first;
+			uint32_t numIds = static_cast<uint32_t>(featureIds.second.size());
+			out.write(reinterpret_cast<const char*>(&feature), sizeof(feature));
+			out.write(reinterpret_cast<const char*>(&numIds), sizeof(numIds));
+			out.write(reinterpret_cast<const char*>(featureIds.second.data()), static_cast<std::streamsize>(numIds * sizeof(uint32_t)));
+		}
+	}
+
+	// Read the next record; false at the end of the file
+	bool readRecord(std::ifstream& in, ResultRecord& record) {
+		constexpr size_t kWords = Colocation::kCapacity / 64;
+		record.key = Colocation();
+		for (size_t w = 0; w < kWords; ++w) {
+			uint64_t word = 0;
+			if (!in.read(reinterpret_cast<char*>(&word), sizeof(word))) return false;
+			for (uint64_t bitsLeft = word; bitsLeft; bitsLeft &= bitsLeft - 1) {
+				record.key.insert(static_cast<FeatureType>(w * 64 + bits::lowestBit(bitsLeft)));
+			}
+		}
+		uint32_t numFeatures = 0;
+		in.read(reinterpret_cast<char*>(&numFeatures), sizeof(numFeatures));
+		record.features.resize(numFeatures);
+		for (auto& featureIds : record.features) {
+			uint16_t feature = 0;
+			uint32_t numIds = 0;
+			in.read(reinterpret_cast<char*>(&feature), sizeof(feature));
+			in.read(reinterpret_cast<char*>(&numIds), sizeof(numIds));
+			featureIds.first = feature;
+			featureIds.second.resize(numIds);
+			in.read(reinterpret_cast<char*>(featureIds.second.data()), static_cast<std::streamsize>(numIds * sizeof(uint32_t)));
+		}
+		if (!in) throw std::runtime_error("Truncated tile result file");
+		return true;
+	}
+
+	// Write a tile's hashmap; std::map already iterates keys in ascending order
+	void writeHashMap(const std::string& path, const CliqueHashMap& hashMap) {
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		if (!out.is_open()) throw std::runtime_error("Cannot write tile result " + path);
+		ResultRecord record;
+		for (const auto& entry : hashMap) {
+			record.key = entry.first;
+			record.features.clear();
+			for (const auto& featureInstances : entry.second) {
+				record.features.emplace_back(featureInstances.first, featureInstances.second.toVector());
+			}
+			std::sort(record.features.begin(), record.features.end(),
+				[](const auto& a, const auto& b) { return a.first < b.first; });
+			writeRecord(out, record);
+		}
+	}
+
+	// Unite the ids of from (same key) into into; feature lists stay sorted
+	void mergeRecord(ResultRecord& into, const ResultRecord& from) {
+		std::vector<std::pair<FeatureType, std::vector<uint32_t>>> merged;
+		merged.reserve(into.features.size() + from.features.size());
+		auto a = into.features.begin();
+		auto b = from.features.begin();
+		while (a != into.features.end() || b != from.features.end()) {
+			if (b == from.features.end() || (a != into.features.end() && a->first < b->first)) {
+				merged.push_back(std::move(*a++));
+			}
+			else if (a == into.features.end() || b->first < a->first) {
+				merged.push_back(*b++);
+			}
+			else {
+				std::vector<uint32_t> ids;
+				ids.reserve(a->second.size() + b->second.size());
+				std::set_union(a->second.begin(), a->second.end(), b->second.begin(), b->second.end(), std::back_inserter(ids));
+				merged.emplace_back(a->first, std::move(ids));
+				++a;
+				++b;
+			}
+		}
+		into.features = std::move(merged);
+	}
+
+	/**
+	 * @brief k-way merge of result files sorted by key
+	 *
+	 * Holds one record per input; onRecord gets every distinct key once, in ascending
+	 * order, with the ids of all inputs united.
+	 */
+	template <typename OnRecord>
+	void mergeRuns(const std::vector<std::string>& paths, OnRecord&& onRecord) {
+		struct Run {
+			std::ifstream in;
+			ResultRecord record;
+			bool valid = false;
+		};
+		std::vector<Run> runs(paths.size());
+		for (size_t i = 0; i < paths.size(); ++i) {
+			runs[i].in.open(paths[i], std::ios::binary);
+			if (!runs[i].in.is_open()) throw std::runtime_error("Cannot read tile result " + paths[i]);
+			runs[i].valid = readRecord(runs[i].in, runs[i].record);
+		}
+
+		ResultRecord current;
+		for (;;) {
+			const Run* first = nullptr;
+			for (const Run& run : runs) {
+				if (run.valid && (!first || run.record.key < first->record.key)) first = &run;
+			}
+			if (!first) break;
+
+			current.key = first->record.key;
+			current.features.clear();
+			for (Run& run : runs) {
+				if (run.valid && run.record.key == current.key) {
+					mergeRecord(current, run.record);
+					run.valid = readRecord(run.in, run.record);
+				}
+			}
+			onRecord(current);
+		}
+	}
+
+	/**
+	 * @brief Forwards only the cliques owned by the current tile
+	 *
+	 * A clique belongs to the tile whose core contains its lowest-id instance.
+	 */
+	class OwnedCliqueSink : public CliqueSink {
+	public:
+		OwnedCliqueSink(const InstanceTable& instances, const std::vector<char>& inCore, CliqueSink& inner)
+			: instances(instances), inCore(inCore), inner(inner) {}
+
+		void onClique(const int32_t* vertices, size_t count) override {
+			int32_t owner = vertices[0];
+			for (size_t i = 1; i < count; ++i) {
+				if (instances.id[vertices[i]] < instances.id[owner]) owner = vertices[i];
+			}
+			if (inCore[owner]) inner.onClique(vertices, count);
+		}
+
+		std::unique_ptr<CliqueSink> fork() override {
+			std::unique_ptr<CliqueSink> innerFork = inner.fork();
+			std::unique_ptr<OwnedCliqueSink> worker(new OwnedCliqueSink(instances, inCore, *innerFork));
+			worker->ownedInner = std::move(innerFork);
+			return worker;
+		}
+
+		void join(CliqueSink& worker) override {
+			inner.join(*static_cast<OwnedCliqueSink&>(worker).ownedInner);
+		}
+
+		void finish() override { inner.finish(); }
+
+	private:
+		const InstanceTable& instances;
+		const std::vector<char>& inCore;
+		CliqueSink& inner;
+		std::unique_ptr<CliqueSink> ownedInner;  ///< Inner sink of a forked worker
+	};
+}
+
+TiledResult TiledExecutor::run(const std::string& datasetPath, NeighborSearchMethod method) {
+	TiledResult result;
+
+	// --- Pass 1: bounding box, feature dictionary, counts ---
+	std::unordered_map<std::string, FeatureType> featureIds;
+	std::vector<std::string> firstSeenNames;
+	std::vector<int> firstSeenCounts;
+	double minX = std::numeric_limits<double>::max(), minY = minX;
+	double maxX = std::numeric_limits<double>::lowest(), maxY = maxX;
+
+	DataLoader::scan(datasetPath, [&](const std::string& featureName, int, double x, double y, double) {
+		auto it = featureIds.find(featureName);
+		if (it == featureIds.end()) {
+			if (firstSeenNames.size() > std::numeric_limits<FeatureType>::max()) {
+				throw std::runtime_error("Too many distinct features in " + datasetPath);
+			}
+			it = featureIds.emplace(featureName, static_cast<FeatureType>(firstSeenNames.size())).first;
+			firstSeenNames.push_back(featureName);
+			firstSeenCounts.push_back(0);
+		}
+		firstSeenCounts[it->second]++;
+		minX = std::min(minX, x); maxX = std::max(maxX, x);
+		minY = std::min(minY, y); maxY = std::max(maxY, y);
+		result.numInstances++;
+		});
+
+	std::vector<FeatureType> remap = DataLoader::rank_feature_names(firstSeenNames, result.featureNames);
+	for (auto& entry : featureIds) entry.second = remap[entry.second];
+	for (size_t i = 0; i < firstSeenCounts.size(); ++i) result.featureCounts[remap[i]] = firstSeenCounts[i];
+	if (result.numInstances == 0) return result;
+
+	TileGrid grid;
+	grid.minX = minX;
+	grid.minY = minY;
+	grid.size = tileSize > 0 ? tileSize : std::max(maxX - minX, maxY - minY) + 1.0;
+	grid.tilesX = std::max(1, static_cast<int>(std::floor((maxX - minX) / grid.size)) + 1);
+	grid.tilesY = std::max(1, static_cast<int>(std::floor((maxY - minY) / grid.size)) + 1);
+	int numTiles = grid.tilesX * grid.tilesY;
+
+	fs::create_directories(workDir);
+
+	// --- Pass 2: bucket rows into every tile whose halo covers them ---
+	{
+		std::vector<std::vector<SpatialInstance>> pending(numTiles);
+		size_t buffered = 0;
+		InstanceID nextId = 0;
+		double d = distanceThreshold;
+
+		// Largest buckets first, until half the budget is free again
+		auto flushLargest = [&]() {
+			std::vector<int> order;
+			for (int t = 0; t < numTiles; ++t) {
+				if (!pending[t].empty()) order.push_back(t);
+			}
+			std::sort(order.begin(), order.end(), [&](int a, int b) { return pending[a].size() > pending[b].size(); });
+			for (int t : order) {
+				if (buffered <= kBufferedRowsBudget / 2) break;
+				buffered -= pending[t].size();
+				appendRows(bucketPath(workDir, t), pending[t]);
+			}
+			};
+
+		for (int t = 0; t < numTiles; ++t) std::remove(bucketPath(workDir, t).c_str());
+
+		DataLoader::scan(datasetPath, [&](const std::string& featureName, int, double x, double y, double) {
+			SpatialInstance instance;
+			instance.type = featureIds[featureName];
+			instance.id = nextId++;
+			instance.x = x;
+			instance.y = y;
+
+			for (int r = grid.row(y - d); r <= grid.row(y + d); ++r) {
+				for (int c = grid.column(x - d); c <= grid.column(x + d); ++c) {
+					int t = grid.index(c, r);
+					pending[t].push_back(instance);
+					buffered++;
+				}
+			}
+			if (buffered > kBufferedRowsBudget) flushLargest();
+			});
+		for (int t = 0; t < numTiles; ++t) appendRows(bucketPath(workDir, t), pending[t]);
+	}
+
+	// --- Per tile: neighbor graph, enumeration of owned cliques, result to disk ---
+	std::vector<std::string> runs;
+	for (int t = 0; t < numTiles; ++t) {
+		std::string bucket = bucketPath(workDir, t);
+		InstanceTable local;
+		{
+			std::vector<SpatialInstance> rows = readRows(bucket);
+			local.reserve(rows.size());
+			for (const auto& instance : rows) local.push_back(instance);
+		}
+		std::remove(bucket.c_str());
+		if (local.empty()) continue;
+
+		int column = t % grid.tilesX;
+		int row = t / grid.tilesX;
+		std::vector<char> inCore(local.size());
+		bool anyCore = false;
+		for (size_t i = 0; i < local.size(); ++i) {
+			inCore[i] = grid.column(local.x[i]) == column && grid.row(local.y[i]) == row;
+			anyCore = anyCore || inCore[i];
+		}
+		if (!anyCore) continue;
+
+		result.numTiles++;
+		result.maxTileInstances = std::max(result.maxTileInstances, local.size());
+
+		NeighborGraph neighborGraph(numThreads);
+		CSRGraph graph = neighborGraph.buildNeighborGraph(local, distanceThreshold, method);
+
+		CliqueHashMap tileMap;
+		HashmapSink tileSink(local, tileMap);
+		OwnedCliqueSink owned(local, inCore, tileSink);
+		MaximalCliqueHashmap mcHashmap(numThreads);
+		mcHashmap.enumerate(graph, owned);
+
+		runs.push_back(resultPath(workDir, t));
+		writeHashMap(runs.back(), tileMap);
+	}
+
+	// --- Merge tile results on disk, kMergeFanIn files at a time ---
+	auto removeAll = [](const std::vector<std::string>& paths) {
+		for (const auto& path : paths) std::remove(path.c_str());
+		};
+	size_t nextRun = 0;
+	while (runs.size() > kMergeFanIn) {
+		std::vector<std::string> merged;
+		for (size_t first = 0; first < runs.size(); first += kMergeFanIn) {
+			std::vector<std::string> group(runs.begin() + first, runs.begin() + std::min(first + kMergeFanIn, runs.size()));
+			merged.push_back(mergePath(workDir, nextRun++));
+			std::ofstream out(merged.back(), std::ios::binary | std::ios::trunc);
+			if (!out.is_open()) throw std::runtime_error("Cannot write tile result " + merged.back());
+			mergeRuns(group, [&](const ResultRecord& record) { writeRecord(out, record); });
+			out.close();
+			removeAll(group);
+		}
+		runs = std::move(merged);
+	}
+
+	// Last pass: every key arrives complete and in order, so it is compressed right away
+	mergeRuns(runs, [&](const ResultRecord& record) {
+		auto& innerMap = result.hashMap.emplace_hint(result.hashMap.end(), record.key, FeatureInstanceMap())->second;
+		for (const auto& featureIds : record.features) {
+			InstanceBitmap& bitmap = innerMap[featureIds.first];
+			for (uint32_t id : featureIds.second) bitmap.add(id);
+			bitmap.runOptimize();
+		}
+		});
+	removeAll(runs);
+
+	return result;
+}
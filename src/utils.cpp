@@ -19,11 +19,11 @@
 
 // Count instances per feature type and sort by frequency (ascending)
 std::map<FeatureType, int> countFeatures(
-	const std::vector<SpatialInstance>& instances) {
+	const InstanceTable& instances) {
 	//////// TODO: Implement (1)//////////
 	std::map<FeatureType, int> counts;
-	for (const auto& instance : instances) {
-		counts[instance.type]++;
+	for (FeatureType f : instances.feature) {
+		counts[f]++;
 	}
 	return counts;
 };
@@ -77,52 +77,39 @@ double calculateDispersion(const std::map<FeatureType, int>& featureCount) {
 	return sigma_log;
 };
 
-// Calculate rare intensity for each instance in a colocation
-std::unordered_map<FeatureType, double> calcRareIntensity(
-	Colocation c,
+// Tabulate W_log = 1 / RI for every (f_min, f) pair of counted features
+WeightTable buildWeightTable(
 	const std::map<FeatureType, int>& featureCounts,
 	double delta) {
-		//////// TODO: Implement (11)//////////
-	std::unordered_map<FeatureType, double> intensityMap;
-	if (c.empty()) return intensityMap;
-
-	// 1. Find N(f_min)
-	// Initialize with first feature's count
-	int minCount = -1;
-	
-	for (const auto& f : c) {
-		if (featureCounts.find(f) != featureCounts.end()) {
-			int count = featureCounts.at(f);
-			if (minCount == -1 || count < minCount) {
-				minCount = count;
-			}
-		}
+	WeightTable table;
+	if (featureCounts.empty()) return table;
+
+	size_t n = static_cast<size_t>(featureCounts.rbegin()->first) + 1;
+	table.numFeatures = n;
+	table.counts.assign(n, 0);
+	table.weights.assign(n * n, 0.0);
+
+	std::vector<double> logCounts(n, 0.0);
+	for (const auto& entry : featureCounts) {
+		if (entry.second <= 0) continue;
+		table.counts[entry.first] = entry.second;
+		logCounts[entry.first] = std::log(static_cast<double>(entry.second));
 	}
 
-	if (minCount <= 0) return intensityMap; 
-
-	// 2. Calculate Rare Intensity (RI) and combined weight factor
+	// Same operation order as the former per-candidate computation, so weighted PIs
+	// are bit-identical (tests/weight_table_test.cpp checks this)
 	double sigmaSq2 = 2.0 * delta * delta;
-	if (sigmaSq2 == 0) sigmaSq2 = 1e-9; 
-
-	double logMin = std::log(static_cast<double>(minCount));
-
-	for (const auto& f : c) {
-		if (featureCounts.find(f) != featureCounts.end()) {
-			int count = featureCounts.at(f);
-			if (count > 0) {
-				// Step 2: Calculate Delta_log
-				double logCount = std::log(static_cast<double>(count));
-				double deltaLog = logCount - logMin;
-
-				// Step 3: Calculate RI
-				double ri = std::exp(-(deltaLog * deltaLog) / sigmaSq2);
-
-				// Store result (Mapping FeatureType -> RI)
-				intensityMap[f] = ri;
-			}
+	if (sigmaSq2 == 0) sigmaSq2 = 1e-9;
+
+	for (size_t fMin = 0; fMin < n; ++fMin) {
+		if (table.counts[fMin] == 0) continue;
+		double logMin = logCounts[fMin];
+		for (size_t f = 0; f < n; ++f) {
+			if (table.counts[f] == 0) continue;
+			double deltaLog = logCounts[f] - logMin;
+			double ri = std::exp(-(deltaLog * deltaLog) / sigmaSq2);
+			table.weights[fMin * n + f] = (ri > 1e-9) ? 1.0 / ri : 0.0;
 		}
 	}
-
-	return intensityMap;
-};
\ No newline at end of file
+	return table;
+}
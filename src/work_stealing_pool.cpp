@@ -0,0 +1,106 @@
+/**
+ * @file work_stealing_pool.cpp
+ * @brief Implementation: Work-stealing thread pool
+ */
+
+#include "work_stealing_pool.h"
+
+namespace {
+	// Index of the pool worker running on this thread, -1 for other threads
+	thread_local int currentWorker = -1;
+	thread_local const WorkStealingPool* currentPool = nullptr;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned numThreads) {
+	if (numThreads == 0) numThreads = 1;
+	for (unsigned i = 0; i < numThreads; ++i) {
+		queues.push_back(std::make_unique<WorkerQueue>());
+	}
+	for (unsigned i = 0; i < numThreads; ++i) {
+		workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+	}
+}
+
+WorkStealingPool::~WorkStealingPool() {
+	wait();
+	{
+		std::lock_guard<std::mutex> lock(idleMutex);
+		stopping = true;
+	}
+	workAvailable.notify_all();
+	for (auto& worker : workers) worker.join();
+}
+
+// Queue a task on the caller's deque (worker) or round-robin (external thread)
+void WorkStealingPool::submit(Task task) {
+	unsigned target = (currentPool == this && currentWorker >= 0)
+		? static_cast<unsigned>(currentWorker)
+		: nextQueue.fetch_add(1) % size();
+
+	pending.fetch_add(1);
+	// Counted under idleMutex before the push: a worker either sees the count in its
+	// wait predicate or is already waiting when notify_one fires
+	{
+		std::lock_guard<std::mutex> lock(idleMutex);
+		queued.fetch_add(1);
+	}
+	{
+		std::lock_guard<std::mutex> lock(queues[target]->mutex);
+		queues[target]->tasks.push_back(std::move(task));
+	}
+	workAvailable.notify_one();
+}
+
+// Owner takes the newest task from the back of its own deque
+bool WorkStealingPool::popLocal(unsigned index, Task& task) {
+	WorkerQueue& q = *queues[index];
+	std::lock_guard<std::mutex> lock(q.mutex);
+	if (q.tasks.empty()) return false;
+	task = std::move(q.tasks.back());
+	q.tasks.pop_back();
+	queued.fetch_sub(1);
+	return true;
+}
+
+// Thief takes the oldest task from the front of another worker's deque
+bool WorkStealingPool::steal(unsigned thief, Task& task) {
+	for (unsigned k = 1; k < size(); ++k) {
+		WorkerQueue& q = *queues[(thief + k) % size()];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		if (q.tasks.empty()) continue;
+		task = std::move(q.tasks.front());
+		q.tasks.pop_front();
+		queued.fetch_sub(1);
+		return true;
+	}
+	return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned index) {
+	currentWorker = static_cast<int>(index);
+	currentPool = this;
+
+	while (true) {
+		Task task;
+		if (popLocal(index, task) || steal(index, task)) {
+			task(index);
+			if (pending.fetch_sub(1) == 1) {
+				std::lock_guard<std::mutex> lock(idleMutex);
+				allDone.notify_all();
+			}
+			continue;
+		}
+
+		// Nothing to run: sleep until a task is queued. A counted task whose push has not
+		// landed yet keeps the predicate true, so the worker retries instead of sleeping.
+		std::unique_lock<std::mutex> lock(idleMutex);
+		workAvailable.wait(lock, [this]() { return stopping || queued.load() > 0; });
+		if (stopping) return;
+	}
+}
+
+// Block until all tasks have finished
+void WorkStealingPool::wait() {
+	std::unique_lock<std::mutex> lock(idleMutex);
+	allDone.wait(lock, [this]() { return pending.load() == 0; });
+}
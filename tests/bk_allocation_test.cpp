@@ -0,0 +1,97 @@
+/**
+ * @file bk_allocation_test.cpp
+ * @brief Test: the Bron-Kerbosch recursion does not allocate per recursion node
+ *
+ * A global operator new counter wraps MaximalCliqueHashmap::enumerate on one of the
+ * bundled datasets at growing distance thresholds. The recursion-node count grows by
+ * three orders of magnitude; the number of heap allocations must stay bounded, and
+ * every allocation beyond the fixed setup must be one the workspace counted itself.
+ */
+
+#include "clique_sink.h"
+#include "data_loader.h"
+#include "maximal_clique_hashmap.h"
+#include "neighbor_graph.h"
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+	bool countingEnabled = false;
+	size_t allocationCount = 0;
+}
+
+void* operator new(std::size_t size) {
+	if (countingEnabled) ++allocationCount;
+	void* p = std::malloc(size ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+void* operator new[](std::size_t size) {
+	if (countingEnabled) ++allocationCount;
+	void* p = std::malloc(size ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+	struct Run {
+		double distance;
+		size_t recursionNodes;
+		size_t counted;   ///< Allocations seen by the global hook
+		size_t reported;  ///< EnumerationStats::heapAllocations
+	};
+
+	// Allocations of one enumerate call; the sink only counts, so it never allocates
+	Run measure(const InstanceTable& instances, double distance) {
+		NeighborGraph neighborGraph;
+		CSRGraph graph = neighborGraph.buildNeighborGraph(instances, distance);
+		MaximalCliqueHashmap mcHashmap(1, false);
+		CountingSink sink;
+
+		allocationCount = 0;
+		countingEnabled = true;
+		mcHashmap.enumerate(graph, sink);
+		countingEnabled = false;
+
+		const auto& stats = mcHashmap.getEnumerationStats();
+		return { distance, stats.recursionNodes, allocationCount, stats.heapAllocations };
+	}
+}
+
+int main() {
+	// Upper bound on the allocations of one enumerate call, whatever the graph size
+	const size_t kMaxAllocations = 64;
+
+	SpatialDataset dataset = DataLoader::load(std::string(COLOCATION_DATA_DIR) + "/gau_mountain.csv");
+
+	std::vector<Run> runs;
+	for (double distance : { 1000.0, 2000.0, 4500.0 }) runs.push_back(measure(dataset.instances, distance));
+
+	bool ok = true;
+	for (const Run& run : runs) {
+		std::cout << "d=" << run.distance << " recursion nodes=" << run.recursionNodes
+			<< " allocations=" << run.counted << " (workspace counted " << run.reported << ")\n";
+		if (run.counted > kMaxAllocations) {
+			std::cerr << "FAIL: " << run.counted << " allocations > " << kMaxAllocations << "\n";
+			ok = false;
+		}
+		// Setup (ordering, workspaces) is fixed; everything else must go through the counter
+		if (run.counted - run.reported != runs[0].counted - runs[0].reported) {
+			std::cerr << "FAIL: allocations outside the workspace counter changed with the graph\n";
+			ok = false;
+		}
+	}
+	if (runs.back().recursionNodes < 100 * runs.front().recursionNodes) {
+		std::cerr << "FAIL: recursion did not grow enough to test steady state\n";
+		ok = false;
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file instance_bitmap_test.cpp
+ * @brief Test: InstanceBitmap container transitions keep the set intact
+ *
+ * Every step is checked against a std::set reference through toVector, forEach,
+ * cardinality and contains. The container form is read off memoryBytes: a bitmap
+ * container owns exactly 8192 bytes of words, an array 2 bytes per value and a run
+ * container 4 bytes per run.
+ */
+
+#include "instance_bitmap.h"
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+	const size_t kBitmapBytes = 8192;
+
+	size_t failures = 0;
+
+	void expect(bool condition, const std::string& what) {
+		if (!condition) {
+			std::cerr << "FAIL: " << what << "\n";
+			++failures;
+		}
+	}
+
+	// Heap bytes of a single-container bitmap minus the container record itself.
+	// Measured on a copy, whose vectors have no spare capacity.
+	size_t payloadBytes(const InstanceBitmap& b) {
+		InstanceBitmap one;
+		one.add(0);
+		size_t containerRecord = one.memoryBytes() - sizeof(uint16_t);
+		InstanceBitmap copy = b;
+		return copy.memoryBytes() - containerRecord;
+	}
+
+	// Compare every read path with the reference
+	void expectSame(const InstanceBitmap& b, const std::set<uint32_t>& reference, const std::string& what) {
+		std::vector<uint32_t> expected(reference.begin(), reference.end());
+		expect(b.toVector() == expected, what + ": toVector");
+		std::vector<uint32_t> visited;
+		b.forEach([&](uint32_t id) { visited.push_back(id); });
+		expect(visited == expected, what + ": forEach");
+		expect(b.cardinality() == reference.size(), what + ": cardinality");
+		expect(b.empty() == reference.empty(), what + ": empty");
+		for (uint32_t id : expected) {
+			if (!b.contains(id)) { expect(false, what + ": contains " + std::to_string(id)); break; }
+			if (reference.count(id + 1) == 0 && b.contains(id + 1)) { expect(false, what + ": stray " + std::to_string(id + 1)); break; }
+		}
+	}
+
+	void add(InstanceBitmap& b, std::set<uint32_t>& reference, uint32_t id) {
+		b.add(id);
+		reference.insert(id);
+	}
+
+	// Array -> bitmap when the 4097th value is added; runOptimize keeps a sparse bitmap
+	void testArrayPromotion() {
+		InstanceBitmap b;
+		std::set<uint32_t> reference;
+		for (uint32_t i = 0; i < 4000; ++i) add(b, reference, i * 3);
+		b.runOptimize();
+		expect(payloadBytes(b) == 4000 * sizeof(uint16_t), "4000 sparse values stay an array");
+		expectSame(b, reference, "array");
+
+		for (uint32_t i = 4000; i < 4097; ++i) add(b, reference, i * 3);
+		expect(payloadBytes(b) == kBitmapBytes, "4097 values become a bitmap");
+		expectSame(b, reference, "array -> bitmap");
+
+		b.runOptimize();
+		expect(payloadBytes(b) == kBitmapBytes, "sparse 4097 values stay a bitmap after runOptimize");
+		expectSame(b, reference, "bitmap after runOptimize");
+	}
+
+	// Unions up to 512 values merge arrays; one more value promotes to a bitmap
+	void testUnionPromotion() {
+		for (uint32_t extra : { 212u, 213u }) {
+			InstanceBitmap a, b;
+			std::set<uint32_t> reference;
+			// No two values adjacent, so runOptimize never picks runs
+			for (uint32_t i = 0; i < 300; ++i) add(a, reference, i * 4);
+			for (uint32_t i = 0; i < extra; ++i) add(b, reference, i * 4 + 2);
+			a.unionWith(b);
+			bool bitmap = payloadBytes(a) == kBitmapBytes;
+			expect(bitmap == (300 + extra > 512), "union of " + std::to_string(300 + extra) + " values: container form");
+			expectSame(a, reference, "union " + std::to_string(300 + extra));
+
+			// runOptimize turns a small bitmap without runs back into an array
+			a.runOptimize();
+			expect(payloadBytes(a) == reference.size() * sizeof(uint16_t), "runOptimize: small bitmap -> array");
+			expectSame(a, reference, "small bitmap -> array");
+		}
+	}
+
+	// Dense ranges become runs; adding to a run goes through a bitmap
+	void testRuns() {
+		InstanceBitmap b;
+		std::set<uint32_t> reference;
+		for (uint32_t v = 1000; v < 6000; ++v) add(b, reference, v);
+		for (uint32_t v = 7000; v < 7100; ++v) add(b, reference, v);
+		b.runOptimize();
+		expect(payloadBytes(b) == 2 * 2 * sizeof(uint16_t), "two dense ranges become a run container");
+		expectSame(b, reference, "runs");
+
+		add(b, reference, 6500);
+		expect(payloadBytes(b) == kBitmapBytes, "adding to a run container converts it to a bitmap");
+		expectSame(b, reference, "run -> bitmap");
+
+		// Unions with a run source, into a bitmap and into a small array
+		InstanceBitmap run;
+		std::set<uint32_t> runReference;
+		for (uint32_t v = 20; v < 60; ++v) add(run, runReference, v);
+		run.runOptimize();
+		expectSame(run, runReference, "small run");
+
+		InstanceBitmap bitmap = b;
+		std::set<uint32_t> bitmapReference = reference;
+		bitmap.unionWith(run);
+		bitmapReference.insert(runReference.begin(), runReference.end());
+		expectSame(bitmap, bitmapReference, "bitmap | run");
+
+		InstanceBitmap array;
+		std::set<uint32_t> arrayReference;
+		for (uint32_t v : { 5u, 25u, 61u, 100u }) add(array, arrayReference, v);
+		array.unionWith(run);
+		arrayReference.insert(runReference.begin(), runReference.end());
+		expectSame(array, arrayReference, "array | run");
+
+		InstanceBitmap runCopy = run;
+		std::set<uint32_t> runCopyReference = runReference;
+		InstanceBitmap small;
+		for (uint32_t v : { 1u, 59u, 60u, 300u }) { small.add(v); runCopyReference.insert(v); }
+		runCopy.unionWith(small);
+		expectSame(runCopy, runCopyReference, "run | array");
+	}
+
+	// Random adds, unions and re-encodings across several high-16-bit keys
+	void testRandom() {
+		std::mt19937 rng(2024);
+		for (int round = 0; round < 200; ++round) {
+			InstanceBitmap b;
+			std::set<uint32_t> reference;
+			int ops = 1 + static_cast<int>(rng() % 8);
+			for (int op = 0; op < ops; ++op) {
+				InstanceBitmap other;
+				std::set<uint32_t> otherReference;
+				uint32_t key = rng() % 3;
+				uint32_t count = rng() % 3 == 0 ? 3000 + rng() % 3000 : rng() % 400;
+				bool dense = rng() % 2 == 0;
+				uint32_t start = rng() % 60000;
+				for (uint32_t i = 0; i < count; ++i) {
+					uint32_t low = dense ? (start + i) & 0xFFFF : rng() & 0xFFFF;
+					add(other, otherReference, (key << 16) | low);
+				}
+				if (rng() % 2) other.runOptimize();
+
+				b.unionWith(other);
+				reference.insert(otherReference.begin(), otherReference.end());
+				if (rng() % 3 == 0) b.runOptimize();
+			}
+			expectSame(b, reference, "random round " + std::to_string(round));
+		}
+	}
+}
+
+int main() {
+	testArrayPromotion();
+	testUnionPromotion();
+	testRuns();
+	testRandom();
+	std::cout << failures << " failures\n";
+	return failures == 0 ? 0 : 1;
+}
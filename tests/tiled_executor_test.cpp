@@ -0,0 +1,115 @@
+/**
+ * @file tiled_executor_test.cpp
+ * @brief Test: the tiled mode reproduces the in-memory clique hashmap
+ *
+ * DataLoader::scan must hand out the same rows as DataLoader::load; the dataset is
+ * larger than one scan block, so rows cross block boundaries. TiledExecutor must then
+ * agree with one enumeration over the whole dataset, for one tile, for a few tiles
+ * (a single merge pass) and for more tiles than one merge pass takes. The small tiles
+ * duplicate enough rows in their halos to exceed the pass-2 row budget.
+ *
+ * The maps are compared as mining reads them (the instances of a key over all keys
+ * containing it), not entry by entry: the RCD branch may also report a subset of a
+ * maximal clique, and which subsets appear depends on the vertex ordering.
+ */
+
+#include "clique_sink.h"
+#include "data_loader.h"
+#include "maximal_clique_hashmap.h"
+#include "neighbor_graph.h"
+#include "tiled_executor.h"
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+	// Rows handed out by scan equal the loaded table, in the same order
+	bool scanMatchesLoad(const std::string& path, const SpatialDataset& dataset) {
+		const InstanceTable& instances = dataset.instances;
+		size_t row = 0;
+		bool ok = true;
+		DataLoader::scan(path, [&](const std::string& featureName, int instanceNumber, double x, double y, double) {
+			if (row >= instances.size()
+				|| dataset.dictionary.featureNames[instances.feature[row]] != featureName
+				|| dataset.dictionary.instanceNumbers[row] != instanceNumber
+				|| instances.x[row] != x || instances.y[row] != y) {
+				ok = false;
+			}
+			row++;
+			});
+		return ok && row == instances.size();
+	}
+
+	// Ids of each feature of c over every key that contains c: what mining reads for c
+	std::map<FeatureType, std::vector<uint32_t>> instancesOf(const CliqueHashMap& hashMap, const Colocation& c) {
+		std::map<FeatureType, InstanceBitmap> united;
+		for (const auto& entry : hashMap) {
+			if (!c.isSubsetOf(entry.first)) continue;
+			for (FeatureType f : c) united[f].unionWith(entry.second.at(f));
+		}
+		std::map<FeatureType, std::vector<uint32_t>> ids;
+		for (const auto& featureInstances : united) ids[featureInstances.first] = featureInstances.second.toVector();
+		return ids;
+	}
+
+	using MiningView = std::map<Colocation, std::map<FeatureType, std::vector<uint32_t>>>;
+
+	// Add what mining reads from hashMap for every key of keys not in view yet
+	void addView(const CliqueHashMap& hashMap, const CliqueHashMap& keys, MiningView& view) {
+		for (const auto& entry : keys) {
+			if (!view.count(entry.first)) view[entry.first] = instancesOf(hashMap, entry.first);
+		}
+	}
+}
+
+int main() {
+	const std::string path = std::string(COLOCATION_DATA_DIR) + "/5k_15f_50k.csv";
+	const double distance = 20.0;
+	const std::string workDir = (fs::temp_directory_path() / "colocation_tiled_test").string();
+
+	SpatialDataset dataset = DataLoader::load(path);
+	bool ok = true;
+	if (!scanMatchesLoad(path, dataset)) {
+		std::cerr << "FAIL: scan rows differ from load\n";
+		ok = false;
+	}
+
+	NeighborGraph neighborGraph;
+	CSRGraph graph = neighborGraph.buildNeighborGraph(dataset.instances, distance);
+	CliqueHashMap expected;
+	HashmapSink sink(dataset.instances, expected);
+	MaximalCliqueHashmap mcHashmap(1);
+	mcHashmap.enumerate(graph, sink);
+	MiningView expectedView;
+	addView(expected, expected, expectedView);
+
+	for (double tileSize : { 1e9, 1000.0, 100.0 }) {
+		TiledExecutor executor(tileSize, distance, 1, workDir);
+		TiledResult tiled = executor.run(path, NeighborSearchMethod::Grid);
+		std::cout << "tile " << tileSize << ": " << tiled.numTiles << " tiles, largest "
+			<< tiled.maxTileInstances << " instances, " << tiled.hashMap.size() << " keys\n";
+
+		MiningView tiledView;
+		addView(tiled.hashMap, expected, tiledView);
+		addView(tiled.hashMap, tiled.hashMap, tiledView);
+		addView(expected, tiled.hashMap, expectedView);
+		bool same = true;
+		for (const auto& key : tiledView) same = same && expectedView.at(key.first) == key.second;
+
+		if (tiled.numInstances != dataset.instances.size() || !same) {
+			std::cerr << "FAIL: tile size " << tileSize << " differs from the in-memory hashmap\n";
+			ok = false;
+		}
+		if (!fs::is_empty(workDir)) {
+			std::cerr << "FAIL: tile size " << tileSize << " left files in " << workDir << "\n";
+			ok = false;
+		}
+	}
+	fs::remove_all(workDir);
+	return ok ? 0 : 1;
+}
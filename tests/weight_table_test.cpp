@@ -0,0 +1,98 @@
+/**
+ * @file weight_table_test.cpp
+ * @brief Test: WeightTable agrees bit for bit with the per-candidate rare-intensity formula
+ *
+ * The miner used to call calcRareIntensity for every candidate and take W_log = 1 / RI.
+ * That function is kept here as the reference: for every feature pair of the bundled
+ * datasets, the tabulated weight must be exactly the weight it yields.
+ */
+
+#include "data_loader.h"
+#include "utils.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+	// Reference: rare intensity of each feature of c (the former utils.cpp implementation)
+	std::unordered_map<FeatureType, double> calcRareIntensity(
+		Colocation c,
+		const std::map<FeatureType, int>& featureCounts,
+		double delta) {
+		std::unordered_map<FeatureType, double> intensityMap;
+		if (c.empty()) return intensityMap;
+
+		int minCount = -1;
+		for (const auto& f : c) {
+			if (featureCounts.find(f) != featureCounts.end()) {
+				int count = featureCounts.at(f);
+				if (minCount == -1 || count < minCount) {
+					minCount = count;
+				}
+			}
+		}
+		if (minCount <= 0) return intensityMap;
+
+		double sigmaSq2 = 2.0 * delta * delta;
+		if (sigmaSq2 == 0) sigmaSq2 = 1e-9;
+
+		double logMin = std::log(static_cast<double>(minCount));
+		for (const auto& f : c) {
+			if (featureCounts.find(f) != featureCounts.end()) {
+				int count = featureCounts.at(f);
+				if (count > 0) {
+					double logCount = std::log(static_cast<double>(count));
+					double deltaLog = logCount - logMin;
+					intensityMap[f] = std::exp(-(deltaLog * deltaLog) / sigmaSq2);
+				}
+			}
+		}
+		return intensityMap;
+	}
+
+	// Compare every (f_min, f) entry of the table with the reference; returns mismatches
+	size_t compare(const std::map<FeatureType, int>& featureCounts, double delta) {
+		WeightTable table = buildWeightTable(featureCounts, delta);
+		size_t mismatches = 0;
+		for (const auto& rare : featureCounts) {
+			for (const auto& other : featureCounts) {
+				if (other.second < rare.second) continue;  // rare must be the rarest feature of the pair
+				Colocation c;
+				c.insert(rare.first);
+				c.insert(other.first);
+				std::unordered_map<FeatureType, double> ri = calcRareIntensity(c, featureCounts, delta);
+				double expected = (ri[other.first] > 1e-9) ? 1.0 / ri[other.first] : 0.0;
+				double actual = table.weight(rare.first, other.first);
+				if (std::memcmp(&expected, &actual, sizeof(double)) != 0) {
+					std::cerr << "FAIL: weight(" << rare.first << ", " << other.first << ") = " << actual
+						<< ", reference " << expected << " (delta " << delta << ")\n";
+					++mismatches;
+				}
+				if (table.count(other.first) != other.second) {
+					std::cerr << "FAIL: count(" << other.first << ") = " << table.count(other.first) << "\n";
+					++mismatches;
+				}
+			}
+		}
+		return mismatches;
+	}
+}
+
+int main() {
+	bool ok = true;
+	for (const char* name : { "sample_data.csv", "gau_mountain.csv", "LasVegas_x_y_alphabet_version_03_2.csv", "5k_15f_50k.csv" }) {
+		SpatialDataset dataset = DataLoader::load(std::string(COLOCATION_DATA_DIR) + "/" + name);
+		std::map<FeatureType, int> featureCounts = countFeatures(dataset.instances);
+		double delta = calculateDispersion(featureCounts);
+
+		// The dataset's own dispersion, plus delta = 0 (the 1e-9 guard)
+		size_t mismatches = compare(featureCounts, delta) + compare(featureCounts, 0.0);
+		std::cout << name << ": " << featureCounts.size() << " features, delta=" << delta
+			<< ", mismatches=" << mismatches << "\n";
+		if (mismatches != 0) ok = false;
+	}
+	return ok ? 0 : 1;
+}